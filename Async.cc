@@ -0,0 +1,28 @@
+#include <chrono>
+#include <functional>
+#include <future>
+#include <utility>
+
+#include "Async.h"
+
+namespace ccsat {
+
+bool SolveHandle::waitFor(double seconds) const {
+  if (!valid())
+    return false;
+
+  return _result.wait_for(std::chrono::duration<double>(seconds)) == std::future_status::ready;
+}
+
+SolveHandle solveAsync(Solver *solver, const CNF &cnf) {
+  // cleared here rather than by the solve, so that a cancel right after the launch is
+  // not lost
+  solver->clearTerminate();
+
+  std::shared_future<Result> result = std::async(std::launch::async,
+      [solver](const CNF &cnf) { return solver->solve(cnf); }, std::cref(cnf)).share();
+
+  return SolveHandle(solver, std::move(result));
+}
+
+}
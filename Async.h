@@ -0,0 +1,61 @@
+#ifndef CCSAT_ASYNC_H
+#define CCSAT_ASYNC_H
+
+#include <future>
+
+#include "SAT.h"
+
+namespace ccsat {
+
+// handle to a solve running on its own thread, see solveAsync. a shared future of the
+// result that can also cancel the solve, copies refer to the same solve.
+// nb: destroying the last handle of a running solve waits for it to finish
+class SolveHandle {
+ public:
+  SolveHandle() {}
+  SolveHandle(Solver *solver, std::shared_future<Result> result)
+      : _solver(solver), _result(std::move(result)) {}
+
+  // returns true if the handle refers to a solve
+  inline bool valid() const { return _result.valid(); }
+
+  // returns true once the result is available, without blocking. false for a handle
+  // that refers to no solve.
+  inline bool ready() const { return waitFor(0); }
+
+  // waits up to seconds for the result, returns true if it is available. returns false
+  // at once for a handle that refers to no solve.
+  bool waitFor(double seconds) const;
+
+  // waits for the result and returns it, rethrows what the solve threw (e.g.
+  // std::bad_alloc). throws std::future_error for a handle that refers to no solve.
+  inline Result get() const {
+    if (!valid())
+      throw std::future_error(std::future_errc::no_state);
+
+    return _result.get();
+  }
+
+  // asks the solve to stop at its next safe point, it then returns UNKNOWN. does
+  // nothing for a handle that refers to no solve.
+  inline void cancel() const {
+    if (valid())
+      _solver->terminate();
+  }
+
+  inline Solver *solver() const { return _solver; }
+
+ private:
+  Solver *_solver = nullptr;
+  std::shared_future<Result> _result;
+};
+
+// starts solving cnf with solver on a new thread and returns a handle to the solve.
+// the model and the memory usage of the solver may be read once the result is ready.
+// nb: solver and cnf must outlive the solve, and solver must not be used otherwise
+//     until it finishes
+SolveHandle solveAsync(Solver *solver, const CNF &cnf);
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef CCSAT_BIT_VECTOR_H
+#define CCSAT_BIT_VECTOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ccsat {
+
+// fixed-size vector of bits packed into 64-bit words, for flags that are scanned in
+// bulk: a word covers 64 entries, so scans over several vectors (see findFirst) combine
+// and test 64 entries per iteration, skipping to the first set bit with ctz.
+class BitVector {
+ public:
+  static const size_t WORD_BITS = 64;
+
+  // resizes to size bits, all set to value. bits past size in the last word stay 0.
+  inline void assign(size_t size, bool value) {
+    _size = size;
+    _words.assign((size + WORD_BITS - 1) / WORD_BITS, value ? ~uint64_t(0) : 0);
+
+    if (value && size % WORD_BITS != 0)
+      _words.back() = (uint64_t(1) << (size % WORD_BITS)) - 1;
+  }
+
+  inline size_t size() const { return _size; }
+  inline size_t numWords() const { return _words.size(); }
+
+  inline bool test(size_t i) const { return (_words[i / WORD_BITS] >> (i % WORD_BITS)) & 1; }
+
+  inline void set(size_t i, bool value) {
+    uint64_t mask = uint64_t(1) << (i % WORD_BITS);
+    _words[i / WORD_BITS] = value ? (_words[i / WORD_BITS] | mask) : (_words[i / WORD_BITS] & ~mask);
+  }
+
+  // sets every bit to 0
+  inline void reset() { std::fill(_words.begin(), _words.end(), 0); }
+
+  inline uint64_t word(size_t w) const { return _words[w]; }
+
+  // returns the bytes allocated for the bits
+  inline size_t bytes() const { return _words.capacity() * sizeof(uint64_t); }
+
+  // returns true if any bit is set
+  inline bool any() const {
+    uint64_t bits = 0;
+    for (auto word : _words)
+      bits |= word;
+
+    return bits != 0;
+  }
+
+ private:
+  size_t _size = 0;
+  std::vector<uint64_t> _words;
+};
+
+// returns the index of the first bit i for which combine(w) has bit i % 64 set, where w
+// is the index of the word containing i, or SIZE_MAX if there is none. combine computes
+// a word of results from words of one or more BitVectors.
+template <class Combine>
+inline size_t findFirst(size_t num_words, Combine combine) {
+  for (size_t w = 0; w < num_words; ++w) {
+    uint64_t bits = combine(w);
+
+    if (bits != 0)
+      return w * BitVector::WORD_BITS + __builtin_ctzll(bits);
+  }
+
+  return SIZE_MAX;
+}
+
+}
+
+#endif
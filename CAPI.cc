@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ccsat.h"
+#include "SAT.h"
+#include "Lookahead.h"
+#include "CDCL.h"
+
+// the state behind a handle of the C API
+struct ccsat_solver {
+  std::unique_ptr<ccsat::Solver> solver;
+
+  // the instance in the binary format of CNF::fromBinary
+  std::vector<int64_t> lits;
+
+  // the model of the last solve as DIMACS literals sorted by variable, empty unless it
+  // answered sat
+  std::vector<int64_t> model;
+};
+
+// returns true if lit can be added, i.e. its variable fits in 63 bits
+static inline bool validLiteral(int64_t lit) {
+  return lit != INT64_MIN;
+}
+
+// ends the clause being built by solver, if any
+static inline void endClause(ccsat_solver *solver) {
+  if (!solver->lits.empty() && solver->lits.back() != 0)
+    solver->lits.push_back(0);
+}
+
+// returns the absolute value of the DIMACS literal lit
+static inline int64_t variable(int64_t lit) {
+  return lit < 0 ? -lit : lit;
+}
+
+extern "C" {
+
+ccsat_solver *ccsat_new(const char *engine) {
+  try {
+    const std::string name = (engine != nullptr) ? engine : "dpll";
+
+    std::unique_ptr<ccsat::Solver> solver;
+    if (name == "dpll")
+      solver.reset(new ccsat::DPLLSolver());
+    else if (name == "lookahead")
+      solver.reset(new ccsat::LookaheadSolver());
+    else if (name == "cdcl")
+      solver.reset(ccsat::makeCDCLSolver("stable", "target", nullptr));
+
+    if (!solver)
+      return nullptr;
+
+    ccsat_solver *handle = new ccsat_solver();
+    handle->solver = std::move(solver);
+    return handle;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void ccsat_delete(ccsat_solver *solver) {
+  delete solver;
+}
+
+int ccsat_add(ccsat_solver *solver, int64_t lit) {
+  if (!validLiteral(lit))
+    return CCSAT_ERROR;
+
+  try {
+    solver->lits.push_back(lit);
+  } catch (...) {
+    return CCSAT_ERROR;
+  }
+
+  return 0;
+}
+
+int ccsat_add_clause(ccsat_solver *solver, const int64_t *lits, size_t count) {
+  if (!std::all_of(lits, lits + count, validLiteral))
+    return CCSAT_ERROR;
+
+  try {
+    endClause(solver);
+    solver->lits.insert(solver->lits.end(), lits, lits + count);
+    solver->lits.push_back(0);
+  } catch (...) {
+    return CCSAT_ERROR;
+  }
+
+  return 0;
+}
+
+void ccsat_clear(ccsat_solver *solver) {
+  solver->lits.clear();
+  solver->model.clear();
+}
+
+void ccsat_set_limits(ccsat_solver *solver, double seconds, uint64_t conflicts,
+    uint64_t decisions, uint64_t propagations, size_t memory) {
+  ccsat::Limits limits;
+  limits.time = seconds;
+  limits.conflicts = conflicts;
+  limits.decisions = decisions;
+  limits.propagations = propagations;
+  limits.memory = memory;
+  solver->solver->setLimits(limits);
+}
+
+int ccsat_solve(ccsat_solver *solver) {
+  solver->model.clear();
+
+  int answer = CCSAT_ERROR;
+  try {
+    // a clause left open counts as ended, later literals start a new one
+    endClause(solver);
+
+    const ccsat::CNF cnf = ccsat::CNF::fromBinary(solver->lits.data(), solver->lits.size());
+    const ccsat::Result result = solver->solver->solve(cnf);
+
+    if (result == ccsat::SAT) {
+      for (const auto &pair : solver->solver->getModel()) {
+        const int64_t var = cnf.name(pair.first);
+        solver->model.push_back(pair.second ? var : -var);
+      }
+
+      std::sort(solver->model.begin(), solver->model.end(),
+          [](int64_t a, int64_t b) { return variable(a) < variable(b); });
+    }
+
+    answer = (result == ccsat::SAT) ? CCSAT_SAT
+        : (result == ccsat::UNSAT) ? CCSAT_UNSAT : CCSAT_UNKNOWN;
+  } catch (...) {
+    solver->model.clear();
+  }
+
+  // a terminate request stands until the end of the solve it stopped
+  solver->solver->clearTerminate();
+
+  return answer;
+}
+
+void ccsat_terminate(ccsat_solver *solver) {
+  solver->solver->terminate();
+}
+
+size_t ccsat_model(const ccsat_solver *solver, int64_t *lits, size_t size) {
+  const std::vector<int64_t> &model = solver->model;
+  std::copy(model.begin(), model.begin() + std::min(size, model.size()), lits);
+
+  return model.size();
+}
+
+int64_t ccsat_value(const ccsat_solver *solver, int64_t var) {
+  if (!validLiteral(var))
+    return 0;
+
+  const std::vector<int64_t> &model = solver->model;
+  auto it = std::lower_bound(model.begin(), model.end(), variable(var),
+      [](int64_t lit, int64_t v) { return variable(lit) < v; });
+
+  return (it != model.end() && variable(*it) == variable(var)) ? *it : 0;
+}
+
+}
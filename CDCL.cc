@@ -0,0 +1,1032 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CDCL.h"
+
+namespace ccsat {
+
+// the arena is compacted once deleted clauses make up this fraction of it
+static const double GC_FRACTION = 0.2;
+
+// watch list entries ahead of the current one whose clauses are prefetched during
+// propagation
+static const size_t PREFETCH_DISTANCE = 4;
+
+// local search budget in flips per input clause, and the probability of a random walk
+// step rather than a greedy one
+static const uint64_t WALK_EFFORT = 10;
+static const double WALK_NOISE = 0.3;
+// flips of the walk between two checks of the limits
+static const uint64_t WALK_CHECK_INTERVAL = 1024;
+
+// conflicts between two checks of the memory budget (only made when there is one),
+// and the fractions of the budget above which every check reduces the learned clauses,
+// and above which the engine turns lean
+static const uint64_t MEMORY_CHECK_INTERVAL = 1000;
+static const double REDUCE_FRACTION = 0.7;
+static const double LEAN_FRACTION = 0.85;
+
+// the template header and name of the engine, for the out-of-line member definitions
+#define CDCL_TEMPLATE \
+  template <class Decision, class Restart, class Phase, class ClauseDB, class Tracer>
+#define CDCL_ENGINE CDCLEngine<Decision, Restart, Phase, ClauseDB, Tracer>
+
+const cref_t ClauseArena::NONE;
+const uint32_t VSIDS::NONE;
+CDCL_TEMPLATE const uint32_t CDCL_ENGINE::NONE;
+CDCL_TEMPLATE const cref_t CDCL_ENGINE::BINARY;
+CDCL_TEMPLATE const cref_t CDCL_ENGINE::FIXED;
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_begin(const CNF &cnf) {
+  _num_vars = cnf.maxVar();
+
+  // give up before allocating if the instance cannot fit the memory budget. the walk
+  // takes about as much memory as the clauses again.
+  const size_t footprint = _footprint(cnf);
+  if (footprint > _maxMemory()) {
+    _finish(UNKNOWN);
+    return;
+  }
+
+  _lean = footprint > std::min(_leanThreshold(), _maxMemory() / 2);
+
+  if (!_init(cnf)) {
+    _tracer.add(nullptr, 0);
+    _finish(UNSAT);
+    return;
+  }
+
+  // loading stops early once a limit is reached or the solve is cancelled
+  if (_limitReached(_conflicts, _decisions, _propagations))
+    _finish(UNKNOWN);
+}
+
+CDCL_TEMPLATE
+Result CDCL_ENGINE::_resume() {
+  Result result = _CDCL();
+  if (result == UNSAT)
+    _tracer.add(nullptr, 0);
+
+  if (result == SAT) {
+    for (size_t i = 0; i < _num_vars; ++i)
+      _model[i + 1] = (_vals[i] == 1);
+  }
+
+  return result;
+}
+
+CDCL_TEMPLATE
+MemoryUsage CDCL_ENGINE::memoryUsage() const {
+  MemoryUsage usage;
+  usage.clauses = _arena.bytes() + bytesOf(_clauses) + bytesOf(_learnts) + bytesOf(_fixed);
+
+  usage.lists = _watches.bytes() + _fixed_watches.bytes() + _binaries.bytes();
+
+  usage.vars = bytesOf(_reason_bins) + bytesOf(_vals) + bytesOf(_levels) + bytesOf(_reasons)
+      + bytesOf(_seen) + bytesOf(_level_stamp) + _decision.bytes() + _phases.bytes();
+  usage.search = bytesOf(_trail) + bytesOf(_trail_lim) + bytesOf(_learnt) + bytesOf(_to_clear)
+      + bytesOf(_stack) + bytesOf(_strengthen);
+
+  return usage;
+}
+
+CDCL_TEMPLATE
+bool CDCL_ENGINE::_init(const CNF &cnf) {
+  const size_t num_vars = _num_vars;
+
+  _arena.clear();
+  _clauses.clear();
+  _learnts.clear();
+  _watches.init(2 * num_vars);
+  _binaries.init(2 * num_vars);
+  _reason_bins.assign(num_vars, {{0, 0}});
+  _vals.assign(num_vars, 0);
+  _levels.assign(num_vars, 0);
+  _reasons.assign(num_vars, ClauseArena::NONE);
+  _trail.clear();
+  _trail_lim.clear();
+  _qhead = 0;
+  _bin_qhead = 0;
+  _seen.assign(num_vars, 0);
+  _learnt.clear();
+  _to_clear.clear();
+  _stack.clear();
+  _strengthen.clear();
+  _level_stamp.assign(num_vars + 1, 0);
+  _stamp = 0;
+  _conflicts = 0;
+  _decisions = 0;
+  _propagations = 0;
+  _rng.seed(0);
+
+  _decision.init(num_vars);
+  _restarts = Restart();
+  _phases.init(num_vars);
+  _db.init();
+  _tracer.init(&cnf);
+
+  // normalize the clauses first, and find whether all clauses longer than 2 (unit and
+  // binary clauses have their own representation) share a width with a specialized
+  // propagation kernel (3 or 4)
+  // nb: when lean the normalized clauses are not kept, they are normalized again when
+  //     they are added
+  std::vector<std::vector<uint32_t>> clauses;
+  std::vector<uint32_t> lits;
+  uint32_t width = 0;
+  bool uniform = true;
+  for (const auto &clause : cnf.clauses) {
+    if (_limitReached(_conflicts, _decisions, _propagations))
+      return true;
+
+    if (!CNF::normalize(clause, lits))
+      continue;
+
+    if (lits.size() > 2) {
+      uniform = uniform && (width == 0 || lits.size() == width);
+      width = lits.size();
+    }
+
+    if (!_lean)
+      clauses.push_back(lits);
+  }
+
+  _fixed_width = (uniform && (width == 3 || width == 4)) ? width : 0;
+  _fixed.clear();
+  _fixed_watches.init(_fixed_width ? 2 * num_vars : 0);
+
+  if (_lean) {
+    for (const auto &clause : cnf.clauses) {
+      if (_limitReached(_conflicts, _decisions, _propagations))
+        return true;
+      if (CNF::normalize(clause, lits) && !_addClause(lits))
+        return false;
+    }
+  } else {
+    for (auto &lits : clauses) {
+      if (_limitReached(_conflicts, _decisions, _propagations))
+        return true;
+      if (!_addClause(lits))
+        return false;
+    }
+  }
+
+  // the lists were filled in clause order, lay them out in literal order
+  _compactLists();
+
+  return true;
+}
+
+CDCL_TEMPLATE
+size_t CDCL_ENGINE::_footprint(const CNF &cnf) const {
+  size_t words = 0;
+  for (const auto &clause : cnf.clauses)
+    words += ClauseArena::words(clause.size());
+
+  // the clauses and two watches per clause, and per variable its assignment state and
+  // the watch and implication lists of both literals
+  return words * sizeof(uint32_t) + cnf.size() * 2 * sizeof(_Watch)
+      + _num_vars * (64 + 6 * ListPool<_Watch>::headerBytes());
+}
+
+CDCL_TEMPLATE
+bool CDCL_ENGINE::_addClause(std::vector<uint32_t> &lits) {
+  // drop literals falsified at the top level, skip satisfied clauses
+  const size_t size = lits.size();
+  size_t j = 0;
+  for (size_t i = 0; i < lits.size(); ++i) {
+    if (_value(lits[i]) == 1)
+      return true;
+
+    if (_value(lits[i]) == 0)
+      lits[j++] = lits[i];
+  }
+  lits.resize(j);
+
+  if (lits.empty())
+    return false;
+
+  // the shortened clause is implied by the top-level units
+  if (j < size)
+    _tracer.add(lits.data(), lits.size());
+
+  if (lits.size() == 1) {
+    _assign(lits[0], ClauseArena::NONE);
+
+    return _propagate() == ClauseArena::NONE;
+  }
+
+  if (lits.size() == 2) {
+    _addBinary(lits[0], lits[1]);
+
+    return true;
+  }
+
+  if (lits.size() == _fixed_width) {
+    if (_fixed.size() / _fixed_width >= BINARY - FIXED)
+      throw std::length_error("fixed-width clauses exceed the clause reference width");
+
+    cref_t index = _fixed.size() / _fixed_width;
+    _fixed.insert(_fixed.end(), lits.begin(), lits.end());
+    _fixed_watches.push(lits[0], {index, lits[1]});
+    _fixed_watches.push(lits[1], {index, lits[0]});
+
+    return true;
+  }
+
+  cref_t cref = _arena.alloc(lits, false);
+  _clauses.push_back(cref);
+  _attach(cref);
+
+  return true;
+}
+
+CDCL_TEMPLATE
+Result CDCL_ENGINE::_CDCL() {
+  while (true) {
+    cref_t confl = _propagate();
+
+    if (confl != ClauseArena::NONE) {
+      if (_decisionLevel() == 0)
+        return UNSAT;
+
+      ++_conflicts;
+      _phases.onConflict(_trail, _vals, _trail_lim.back());
+
+      size_t trail = _trail.size();
+      uint32_t level;
+      uint32_t lbd = _analyze(confl, &level);
+
+      _backtrack(level);
+      _tracer.add(_learnt.data(), _learnt.size());
+
+      if (_learnt.size() == 1) {
+        _assign(_learnt[0], ClauseArena::NONE);
+      } else if (_learnt.size() == 2) {
+        _addBinary(_learnt[0], _learnt[1]);
+        _assignBinary(_learnt[0], _learnt[1]);
+      } else {
+        cref_t cref = _arena.alloc(_learnt, true);
+        _db.learnt(_arena, cref, lbd);
+        _learnts.push_back(cref);
+        _attach(cref);
+        _assign(_learnt[0], cref);
+      }
+
+      _strengthenClauses();
+
+      _decision.decay();
+      _db.decay();
+      _restarts.onConflict(lbd, trail);
+
+      if (_db.shouldReduce(_conflicts) && !_reduceDB())
+        return UNKNOWN;
+
+      if (_maxMemory() != SIZE_MAX && _conflicts % MEMORY_CHECK_INTERVAL == 0 && !_checkMemory())
+        return UNKNOWN;
+
+      continue;
+    }
+
+    if (_restarts.shouldRestart()) {
+      _backtrack(0);
+      _restarts.onRestart();
+      _phases.onRestart();
+    }
+
+    if (_phases.shouldRephase(_conflicts)) {
+      _backtrack(0);
+      _phases.rephase(_conflicts, [this](std::vector<int8_t> &phases) { _walk(phases); });
+    }
+
+    // the search can be resumed from here
+    if (_shouldYield(_conflicts, _decisions, _propagations))
+      return UNKNOWN;
+
+    uint32_t lit = _pickBranch();
+    if (lit == NONE)
+      return SAT;
+
+    ++_decisions;
+    _trail_lim.push_back(_trail.size());
+    _assign(lit, ClauseArena::NONE);
+  }
+}
+
+CDCL_TEMPLATE
+bool CDCL_ENGINE::_checkMemory() {
+  const size_t budget = _maxMemory();
+
+  if (memoryUsage().total() > REDUCE_FRACTION * budget) {
+    if (!_reduceDB())
+      return false;
+
+    // compact right away, the deleted clauses only give memory back once moved out
+    if (_arena.wasted() > 0)
+      _collectGarbage();
+  }
+
+  const size_t used = memoryUsage().total();
+  if (used > LEAN_FRACTION * budget)
+    _lean = true;
+
+  return used <= budget;
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_addBinary(uint32_t a, uint32_t b) {
+  _binaries.push(a, b);
+  _binaries.push(b, a);
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_assignBinary(uint32_t lit, uint32_t other) {
+  _assign(lit, BINARY);
+  _reason_bins[lit >> 1] = {{lit, other}};
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_attach(cref_t cref) {
+  const uint32_t *lits = _arena.lits(cref);
+
+  _watches.push(lits[0], {cref, lits[1]});
+  _watches.push(lits[1], {cref, lits[0]});
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_assign(uint32_t lit, cref_t reason) {
+  uint32_t var = lit >> 1;
+
+  _vals[var] = (lit & 1) ? -1 : 1;
+  _levels[var] = _decisionLevel();
+  _reasons[var] = reason;
+  _trail.push_back(lit);
+  ++_propagations;
+}
+
+CDCL_TEMPLATE
+cref_t CDCL_ENGINE::_propagate() {
+  cref_t confl = ClauseArena::NONE;
+
+  while (_qhead < _trail.size()) {
+    // binary implications of every pending literal go first, they need no clause
+    // memory and often make the long clause visits below unnecessary
+    while (_bin_qhead < _trail.size()) {
+      uint32_t false_lit = _trail[_bin_qhead++] ^ 1;
+
+      for (auto implied : _binaries[false_lit]) {
+        int8_t value = _value(implied);
+
+        if (value == 1)
+          continue;
+
+        if (value == -1) {
+          _conflict_bin = {{implied, false_lit}};
+          _qhead = _bin_qhead = _trail.size();
+
+          return BINARY;
+        }
+
+        _assignBinary(implied, false_lit);
+      }
+    }
+
+    // the negation of the propagated literal became false
+    uint32_t false_lit = _trail[_qhead++] ^ 1;
+
+    // the watch list of the next literal is visited right after this one
+    if (_qhead < _trail.size()) {
+      prefetch(_watches[_trail[_qhead] ^ 1].begin());
+      if (_fixed_width)
+        prefetch(_fixed_watches[_trail[_qhead] ^ 1].begin());
+    }
+
+    // input clauses of the uniform width go through the specialized kernel
+    if (_fixed_width == 3)
+      confl = _propagateFixed<3>(false_lit);
+    else if (_fixed_width == 4)
+      confl = _propagateFixed<4>(false_lit);
+
+    if (confl != ClauseArena::NONE) {
+      _qhead = _bin_qhead = _trail.size();
+      break;
+    }
+
+    // nb: pushing to the list of another literal may move the pool, watches is looked
+    //     up again after every push
+    auto watches = _watches[false_lit];
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < watches.size()) {
+      // the clause visits are dependent loads into the arena, start them early
+      if (i + PREFETCH_DISTANCE < watches.size())
+        _arena.prefetch(watches[i + PREFETCH_DISTANCE].cref);
+
+      // satisfied by the blocker, the clause itself is not needed
+      if (_value(watches[i].blocker) == 1) {
+        watches[j++] = watches[i++];
+        continue;
+      }
+
+      cref_t cref = watches[i++].cref;
+      uint32_t *lits = _arena.lits(cref);
+
+      // keep the false watch in the second position
+      if (lits[0] == false_lit)
+        std::swap(lits[0], lits[1]);
+
+      // the other watch is a better blocker if it is true
+      if (_value(lits[0]) == 1) {
+        watches[j++] = {cref, lits[0]};
+        continue;
+      }
+
+      // look for a replacement watch among the unwatched literals, circularly from
+      // where the previous search stopped
+      bool replaced = false;
+      const uint32_t size = _arena.size(cref);
+      uint32_t start = _arena.searchPos(cref);
+      if (start >= size)
+        start = 2;
+
+      uint32_t k = start;
+      do {
+        if (_value(lits[k]) != -1) {
+          std::swap(lits[1], lits[k]);
+          _watches.push(lits[1], {cref, lits[0]});
+          watches = _watches[false_lit];
+          _arena.setSearchPos(cref, k);
+          replaced = true;
+          break;
+        }
+
+        if (++k == size)
+          k = 2;
+      } while (k != start);
+
+      if (replaced)
+        continue;
+
+      // the clause is unit or conflicting
+      watches[j++] = {cref, lits[0]};
+
+      if (_value(lits[0]) == -1) {
+        confl = cref;
+        _qhead = _bin_qhead = _trail.size();
+
+        while (i < watches.size())
+          watches[j++] = watches[i++];
+      } else {
+        _assign(lits[0], cref);
+      }
+    }
+
+    _watches.shrink(false_lit, j);
+
+    if (confl != ClauseArena::NONE)
+      break;
+  }
+
+  return confl;
+}
+
+CDCL_TEMPLATE
+template <unsigned K>
+cref_t CDCL_ENGINE::_propagateFixed(uint32_t false_lit) {
+  // nb: looked up again after every push, see _propagate
+  auto watches = _fixed_watches[false_lit];
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < watches.size()) {
+    if (i + PREFETCH_DISTANCE < watches.size())
+      prefetch(&_fixed[size_t(watches[i + PREFETCH_DISTANCE].cref) * K]);
+
+    if (_value(watches[i].blocker) == 1) {
+      watches[j++] = watches[i++];
+      continue;
+    }
+
+    cref_t index = watches[i++].cref;
+    uint32_t *lits = &_fixed[size_t(index) * K];
+
+    // move the false watch to the second position without branching
+    uint32_t other = lits[0] ^ lits[1] ^ false_lit;
+    lits[0] = other;
+    lits[1] = false_lit;
+
+    if (_value(other) == 1) {
+      watches[j++] = {index, other};
+      continue;
+    }
+
+    // select a non-false unwatched literal with conditional moves, the loop is
+    // unrolled for every width
+    unsigned k = 2;
+    for (unsigned r = 3; r < K; ++r)
+      k = (_value(lits[r]) != -1) ? r : k;
+
+    if (_value(lits[k]) != -1) {
+      lits[1] = lits[k];
+      lits[k] = false_lit;
+      _fixed_watches.push(lits[1], {index, other});
+      watches = _fixed_watches[false_lit];
+      continue;
+    }
+
+    // the clause is unit or conflicting
+    watches[j++] = {index, other};
+
+    if (_value(other) == -1) {
+      while (i < watches.size())
+        watches[j++] = watches[i++];
+      _fixed_watches.shrink(false_lit, j);
+
+      return FIXED + index;
+    }
+
+    _assign(other, FIXED + index);
+  }
+
+  _fixed_watches.shrink(false_lit, j);
+
+  return ClauseArena::NONE;
+}
+
+CDCL_TEMPLATE
+uint32_t CDCL_ENGINE::_analyze(cref_t confl, uint32_t *out_level) {
+  // leave room for the asserting literal
+  _learnt.assign(1, NONE);
+
+  const uint32_t level = _decisionLevel();
+  uint32_t paths = 0;
+  uint32_t lit = NONE;
+  size_t index = _trail.size();
+
+  do {
+    const uint32_t *lits;
+    uint32_t size;
+
+    if (confl == BINARY) {
+      lits = (lit == NONE) ? _conflict_bin.data() : _reason_bins[lit >> 1].data();
+      size = 2;
+    } else if (confl >= FIXED) {
+      lits = &_fixed[size_t(confl - FIXED) * _fixed_width];
+      size = _fixed_width;
+    } else {
+      if (_arena.learnt(confl))
+        _db.bump(_arena, confl, _learnts,
+            [this](cref_t cref) { return _computeLbd(_arena.lits(cref), _arena.size(cref)); });
+
+      lits = _arena.lits(confl);
+      size = _arena.size(confl);
+    }
+
+    // the first literal of a reason clause is the one it implied
+    uint32_t assigned = 0;
+    for (uint32_t k = (lit == NONE) ? 0 : 1; k < size; ++k) {
+      uint32_t var = lits[k] >> 1;
+
+      if (_levels[var] == 0)
+        continue;
+
+      ++assigned;
+      if (_seen[var])
+        continue;
+
+      _seen[var] = 1;
+      _decision.bump(var);
+
+      if (_levels[var] >= level)
+        ++paths;
+      else
+        _learnt.push_back(lits[k]);
+    }
+
+    // on-the-fly subsumption: if the resolvent consists of the antecedent minus the
+    // literal it implied, that literal can be removed from the antecedent
+    if (lit != NONE && confl < FIXED && size > 3 && _learnt.size() - 1 + paths == assigned)
+      _strengthen.push_back(confl);
+
+    // walk back to the next literal of the current level involved in the conflict
+    while (!_seen[_trail[--index] >> 1]);
+
+    lit = _trail[index];
+    confl = _reasons[lit >> 1];
+    _seen[lit >> 1] = 0;
+    --paths;
+  } while (paths > 0);
+
+  _learnt[0] = lit ^ 1;
+
+  // recursive minimization: drop the literals implied by the rest of the clause
+  _to_clear.assign(_learnt.begin() + 1, _learnt.end());
+
+  uint32_t levels = 0;
+  for (size_t i = 1; i < _learnt.size(); ++i)
+    levels |= _abstractLevel(_learnt[i] >> 1);
+
+  size_t j = 1;
+  for (size_t i = 1; i < _learnt.size(); ++i) {
+    if (_reasons[_learnt[i] >> 1] == ClauseArena::NONE || !_redundant(_learnt[i], levels))
+      _learnt[j++] = _learnt[i];
+  }
+  _learnt.resize(j);
+
+  for (auto lit : _to_clear)
+    _seen[lit >> 1] = 0;
+
+  // backjump to the second highest level, watched in the second position
+  *out_level = 0;
+  if (_learnt.size() > 1) {
+    size_t max = 1;
+    for (size_t i = 2; i < _learnt.size(); ++i)
+      if (_levels[_learnt[i] >> 1] > _levels[_learnt[max] >> 1])
+        max = i;
+
+    std::swap(_learnt[1], _learnt[max]);
+    *out_level = _levels[_learnt[1] >> 1];
+  }
+
+  return _computeLbd(_learnt.data(), _learnt.size());
+}
+
+CDCL_TEMPLATE
+bool CDCL_ENGINE::_redundant(uint32_t lit, uint32_t levels) {
+  size_t top = _to_clear.size();
+
+  _stack.assign(1, lit);
+  while (!_stack.empty()) {
+    uint32_t var = _stack.back() >> 1;
+    _stack.pop_back();
+
+    const uint32_t *lits = _reasonLits(var);
+    const uint32_t size = _reasonSize(var);
+    for (uint32_t k = 1; k < size; ++k) {
+      var = lits[k] >> 1;
+
+      if (_seen[var] || _levels[var] == 0)
+        continue;
+
+      // a decision, or a literal from a level that does not occur in the clause,
+      // cannot be implied by the clause
+      if (_reasons[var] == ClauseArena::NONE || !(_abstractLevel(var) & levels)) {
+        for (size_t i = top; i < _to_clear.size(); ++i)
+          _seen[_to_clear[i] >> 1] = 0;
+        _to_clear.resize(top);
+
+        return false;
+      }
+
+      _seen[var] = 1;
+      _stack.push_back(lits[k]);
+      _to_clear.push_back(lits[k]);
+    }
+  }
+
+  return true;
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_strengthenClauses() {
+  for (auto cref : _strengthen) {
+    uint32_t *lits = _arena.lits(cref);
+    uint32_t size = _arena.size(cref);
+
+    _detach(cref);
+
+    // the implied literal is the first one, the rest is a resolvent derived in conflict
+    // analysis
+    _tracer.add(lits + 1, size - 1);
+    _tracer.remove(lits, size);
+
+    lits[0] = lits[size - 1];
+    _arena.shrink(cref, --size);
+
+    // watch non-false literals first, then the false ones assigned last
+    for (uint32_t w = 0; w < 2; ++w) {
+      uint32_t best = w;
+      for (uint32_t k = w + 1; k < size; ++k) {
+        if (_watchRank(lits[k]) > _watchRank(lits[best]))
+          best = k;
+      }
+
+      std::swap(lits[w], lits[best]);
+    }
+
+    _attach(cref);
+  }
+
+  _strengthen.clear();
+}
+
+CDCL_TEMPLATE
+uint64_t CDCL_ENGINE::_watchRank(uint32_t lit) const {
+  if (_value(lit) != -1)
+    return UINT64_MAX;
+
+  return _levels[lit >> 1];
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_detach(cref_t cref) {
+  const uint32_t *lits = _arena.lits(cref);
+
+  for (uint32_t w = 0; w < 2; ++w) {
+    auto watches = _watches[lits[w]];
+    for (size_t i = 0; i < watches.size(); ++i) {
+      if (watches[i].cref == cref) {
+        watches[i] = watches[watches.size() - 1];
+        _watches.shrink(lits[w], watches.size() - 1);
+        break;
+      }
+    }
+  }
+}
+
+CDCL_TEMPLATE
+uint32_t CDCL_ENGINE::_computeLbd(const uint32_t *lits, size_t size) {
+  ++_stamp;
+
+  uint32_t lbd = 0;
+  for (size_t i = 0; i < size; ++i) {
+    uint32_t level = _levels[lits[i] >> 1];
+
+    if (_level_stamp[level] != _stamp) {
+      _level_stamp[level] = _stamp;
+      ++lbd;
+    }
+  }
+
+  return lbd;
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_backtrack(uint32_t level) {
+  if (_decisionLevel() <= level)
+    return;
+
+  for (size_t i = _trail.size(); i > _trail_lim[level]; --i) {
+    uint32_t var = _trail[i - 1] >> 1;
+
+    _phases.unassigned(var, _vals[var]);
+    _vals[var] = 0;
+    _reasons[var] = ClauseArena::NONE;
+    _decision.unassigned(var);
+  }
+
+  _trail.resize(_trail_lim[level]);
+  _trail_lim.resize(level);
+  _qhead = _bin_qhead = _trail.size();
+}
+
+CDCL_TEMPLATE
+uint32_t CDCL_ENGINE::_pickBranch() {
+  uint32_t var = _decision.next(_vals);
+  if (var == Decision::NONE)
+    return NONE;
+
+  return (_phases.phase(var, _restarts.stable()) > 0) ? 2 * var : 2 * var + 1;
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_walk(std::vector<int8_t> &phases) {
+  // the occurrence lists of the walk would take about as much memory as the clauses
+  if (_lean)
+    return;
+
+  const size_t num_lits = _watches.numKeys();
+
+  // start from the given phases, keeping the top-level assignment
+  std::vector<int8_t> vals(phases);
+  for (auto lit : _trail)
+    vals[lit >> 1] = _vals[lit >> 1];
+
+  auto is_true = [&vals](uint32_t lit) {
+    return ((lit & 1) ? -vals[lit >> 1] : vals[lit >> 1]) > 0;
+  };
+
+  // the input clauses and binary clauses, flattened
+  std::vector<uint32_t> clause_lits;
+  std::vector<size_t> clause_start;
+  for (auto cref : _clauses) {
+    clause_start.push_back(clause_lits.size());
+    clause_lits.insert(clause_lits.end(), _arena.lits(cref), _arena.lits(cref) + _arena.size(cref));
+  }
+
+  for (size_t k = 0; k < _fixed.size(); k += _fixed_width) {
+    clause_start.push_back(clause_lits.size());
+    clause_lits.insert(clause_lits.end(), &_fixed[k], &_fixed[k] + _fixed_width);
+  }
+
+  for (uint32_t lit = 0; lit < num_lits; ++lit) {
+    for (auto other : _binaries[lit]) {
+      if (lit < other) {
+        clause_start.push_back(clause_lits.size());
+        clause_lits.push_back(lit);
+        clause_lits.push_back(other);
+      }
+    }
+  }
+
+  const size_t num_clauses = clause_start.size();
+  clause_start.push_back(clause_lits.size());
+
+  // lit -> clauses containing lit, per clause number of true literals, and the
+  // falsified clauses with their positions in it
+  std::vector<std::vector<uint32_t>> occs(num_lits);
+  std::vector<uint32_t> num_true(num_clauses, 0);
+  std::vector<uint32_t> unsat;
+  std::vector<size_t> unsat_pos(num_clauses, 0);
+
+  for (uint32_t c = 0; c < num_clauses; ++c) {
+    for (size_t k = clause_start[c]; k < clause_start[c + 1]; ++k) {
+      occs[clause_lits[k]].push_back(c);
+      num_true[c] += is_true(clause_lits[k]);
+    }
+
+    if (num_true[c] == 0) {
+      unsat_pos[c] = unsat.size();
+      unsat.push_back(c);
+    }
+  }
+
+  std::vector<int8_t> best(vals);
+  size_t best_unsat = unsat.size();
+
+  std::uniform_real_distribution<double> coin(0, 1);
+  const uint64_t flips = WALK_EFFORT * num_clauses;
+  for (uint64_t flip = 0; flip < flips && !unsat.empty(); ++flip) {
+    if (flip % WALK_CHECK_INTERVAL == 0 && _limitReached(_conflicts, _decisions, _propagations))
+      break;
+
+    uint32_t c = unsat[_rng() % unsat.size()];
+    const uint32_t *lits = &clause_lits[clause_start[c]];
+    const uint32_t size = clause_start[c + 1] - clause_start[c];
+
+    // pick the literal whose flip breaks the fewest clauses, or a random one
+    uint32_t pick = NONE;
+    size_t pick_breaks = SIZE_MAX;
+    for (uint32_t k = 0; k < size; ++k) {
+      // top-level assignments are never flipped
+      if (_vals[lits[k] >> 1] != 0 && _levels[lits[k] >> 1] == 0)
+        continue;
+
+      size_t breaks = 0;
+      for (auto d : occs[lits[k] ^ 1])
+        breaks += (num_true[d] == 1);
+
+      if (breaks < pick_breaks) {
+        pick = lits[k];
+        pick_breaks = breaks;
+      }
+    }
+
+    if (pick == NONE)
+      continue;
+
+    if (pick_breaks > 0 && coin(_rng) < WALK_NOISE) {
+      uint32_t k = _rng() % size;
+      if (_vals[lits[k] >> 1] == 0 || _levels[lits[k] >> 1] != 0)
+        pick = lits[k];
+    }
+
+    // make pick true
+    vals[pick >> 1] = (pick & 1) ? -1 : 1;
+
+    for (auto d : occs[pick]) {
+      if (num_true[d]++ == 0) {
+        unsat_pos[unsat.back()] = unsat_pos[d];
+        unsat[unsat_pos[d]] = unsat.back();
+        unsat.pop_back();
+      }
+    }
+
+    for (auto d : occs[pick ^ 1]) {
+      if (--num_true[d] == 0) {
+        unsat_pos[d] = unsat.size();
+        unsat.push_back(d);
+      }
+    }
+
+    if (unsat.size() < best_unsat) {
+      best = vals;
+      best_unsat = unsat.size();
+    }
+  }
+
+  phases = best;
+}
+
+CDCL_TEMPLATE
+bool CDCL_ENGINE::_reduceDB() {
+  _db.reduce(_arena, _learnts, _conflicts, [this](cref_t cref) { return _locked(cref); });
+
+  for (auto cref : _learnts)
+    if (_arena.deleted(cref))
+      _tracer.remove(_arena.lits(cref), _arena.size(cref));
+
+  _learnts.erase(std::remove_if(_learnts.begin(), _learnts.end(),
+      [this](cref_t cref) { return _arena.deleted(cref); }), _learnts.end());
+
+  for (size_t lit = 0; lit < _watches.numKeys(); ++lit) {
+    if (_limitReached(_conflicts, _decisions, _propagations))
+      return false;
+
+    auto watches = _watches[lit];
+    auto end = std::remove_if(watches.begin(), watches.end(),
+        [this](const _Watch &watch) { return _arena.deleted(watch.cref); });
+    _watches.shrink(lit, end - watches.begin());
+  }
+
+  _compactLists();
+
+  if (_arena.wasted() > GC_FRACTION * _arena.words())
+    _collectGarbage();
+
+  return true;
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_compactLists() {
+  if (_watches.wasted() > 0)
+    _watches.compact();
+  if (_fixed_watches.wasted() > 0)
+    _fixed_watches.compact();
+  if (_binaries.wasted() > 0)
+    _binaries.compact();
+}
+
+CDCL_TEMPLATE
+void CDCL_ENGINE::_collectGarbage() {
+  ClauseArena to;
+  to.reserve(_arena.words() - _arena.wasted());
+
+  // clauses watched by the same literal end up next to each other, which is the
+  // order propagation visits them in
+  for (size_t lit = 0; lit < _watches.numKeys(); ++lit)
+    for (auto &watch : _watches[lit])
+      watch.cref = _arena.relocate(watch.cref, to);
+
+  // every live clause is watched, so these only pick up forwarding references
+  for (auto lit : _trail) {
+    cref_t &reason = _reasons[lit >> 1];
+    if (reason < FIXED)
+      reason = _arena.relocate(reason, to);
+  }
+
+  for (auto &cref : _clauses)
+    cref = _arena.relocate(cref, to);
+
+  for (auto &cref : _learnts)
+    cref = _arena.relocate(cref, to);
+
+  _arena = std::move(to);
+}
+
+CDCL_TEMPLATE
+bool CDCL_ENGINE::_locked(cref_t cref) const {
+  uint32_t lit = _arena.lits(cref)[0];
+
+  return _value(lit) == 1 && _reasons[lit >> 1] == cref;
+}
+
+// the prebuilt combinations, differing in restart policy, phase policy and proof tracer
+template <class Restart, class Phase>
+static Solver *makeWithPhases(std::ostream *proof) {
+  if (proof)
+    return new CDCLEngine<VSIDS, Restart, Phase, TieredDB, DratTracer>(DratTracer(proof));
+
+  return new CDCLEngine<VSIDS, Restart, Phase, TieredDB, NoTracer>();
+}
+
+template <class Restart>
+static Solver *makeWithRestarts(const std::string &phase, std::ostream *proof) {
+  if (phase == "target")
+    return makeWithPhases<Restart, TargetPhases>(proof);
+  if (phase == "saved")
+    return makeWithPhases<Restart, SavedPhases>(proof);
+
+  return nullptr;
+}
+
+Solver *makeCDCLSolver(const std::string &restart, const std::string &phase, std::ostream *proof) {
+  if (restart == "luby")
+    return makeWithRestarts<LubyRestart>(phase, proof);
+  if (restart == "glucose")
+    return makeWithRestarts<GlucoseRestart>(phase, proof);
+  if (restart == "stable")
+    return makeWithRestarts<ModeSwitchRestart>(phase, proof);
+
+  return nullptr;
+}
+
+template class CDCLEngine<VSIDS, ModeSwitchRestart, TargetPhases, TieredDB, NoTracer>;
+
+#undef CDCL_TEMPLATE
+#undef CDCL_ENGINE
+
+}
@@ -0,0 +1,263 @@
+#ifndef CCSAT_CDCL_H
+#define CCSAT_CDCL_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SAT.h"
+#include "ClauseArena.h"
+#include "ClauseDB.h"
+#include "Decision.h"
+#include "ListPool.h"
+#include "Memory.h"
+#include "Phase.h"
+#include "Proof.h"
+#include "Restart.h"
+
+namespace ccsat {
+
+// conflict-driven clause learning solver: binary clauses in implication lists, input
+// clauses of a uniform width 3 or 4 in fixed-width storage with specialized propagation
+// kernels, two watched literals for longer clauses, first-UIP learning with
+// non-chronological backjumping, VSIDS branching, phase saving with target phases and
+// periodic rephasing, a tiered learned clause database with periodic reduction, and a
+// restart policy.
+//
+// the tunable parts are policy classes (see Decision.h, Restart.h, Phase.h, ClauseDB.h
+// and Proof.h) rather than virtual interfaces, so that every combination is compiled
+// with its policies inlined into the search loop. the definitions are in CDCL.cc, which
+// instantiates the combinations makeCDCLSolver can return.
+template <class Decision, class Restart, class Phase, class ClauseDB, class Tracer>
+class CDCLEngine : public Solver {
+ public:
+  explicit CDCLEngine(Tracer tracer = Tracer()) : _tracer(tracer) {}
+
+  MemoryUsage memoryUsage() const override;
+
+ protected:
+  void _begin(const CNF &cnf) override;
+  Result _resume() override;
+
+ private:
+  // an entry of a watch list: a clause watching the literal the list belongs to, and
+  // a blocking literal of that clause. if the blocker is true the clause is satisfied
+  // and propagation does not need to look at it.
+  struct _Watch {
+    cref_t cref;
+    uint32_t blocker;
+  };
+
+  // initializes the solver on the given CNF SAT instance, _num_vars must be set for it
+  // returns false if the instance is refuted while loading it. stops early (returning
+  // true) once a limit is reached.
+  bool _init(const CNF &cnf);
+  Result _CDCL();
+
+  // checks the memory budget, degrading the search as it is approached: learned
+  // clauses are reduced at every check above REDUCE_FRACTION of the budget, and the
+  // engine turns lean above LEAN_FRACTION. returns false if the budget is exceeded
+  // anyway.
+  bool _checkMemory();
+
+  // adds a clause of the input (literals already deduplicated), returns false if it
+  // is refuted by the current top-level assignment
+  bool _addClause(std::vector<uint32_t> &lits);
+
+  // returns the estimated memory footprint in bytes of cnf loaded into the engine
+  size_t _footprint(const CNF &cnf) const;
+
+  // adds the binary clause (a, b) to the implication lists
+  void _addBinary(uint32_t a, uint32_t b);
+
+  // assigns lit, implied by the binary clause (lit, other)
+  void _assignBinary(uint32_t lit, uint32_t other);
+
+  // watches the first two literals of cref
+  void _attach(cref_t cref);
+
+  // assigns lit at the current decision level with the given reason
+  void _assign(uint32_t lit, cref_t reason);
+
+  // propagates all enqueued assignments, returns the conflicting clause or NONE
+  cref_t _propagate();
+
+  // visits the fixed-width clauses watching false_lit, returns the conflicting clause
+  // (FIXED + index) or NONE
+  template <unsigned K>
+  cref_t _propagateFixed(uint32_t false_lit);
+
+  // derives the minimized first-UIP clause of the conflict into _learnt (asserting
+  // literal first), outputs the backjump level and returns the LBD of the clause.
+  // antecedents subsumed by a resolvent are queued in _strengthen.
+  uint32_t _analyze(cref_t confl, uint32_t *out_level);
+
+  // returns true if lit (of the learned clause) is implied by the other literals of
+  // the clause, following reasons recursively. levels is the abstraction of the
+  // decision levels of the clause, used to give up early.
+  bool _redundant(uint32_t lit, uint32_t levels);
+
+  // removes the implied literal from every antecedent queued in _strengthen and
+  // watches them again, must be called after backjumping
+  void _strengthenClauses();
+
+  // order in which literals are picked as watches when rewatching a clause
+  uint64_t _watchRank(uint32_t lit) const;
+
+  // removes cref from the watch lists of its first two literals
+  void _detach(cref_t cref);
+
+  // the literals of the reason of the assigned var, the first one being implied
+  inline const uint32_t *_reasonLits(uint32_t var) const {
+    cref_t reason = _reasons[var];
+
+    if (reason == BINARY)
+      return _reason_bins[var].data();
+    if (reason >= FIXED)
+      return &_fixed[size_t(reason - FIXED) * _fixed_width];
+
+    return _arena.lits(reason);
+  }
+
+  inline uint32_t _reasonSize(uint32_t var) const {
+    cref_t reason = _reasons[var];
+
+    if (reason == BINARY)
+      return 2;
+    if (reason >= FIXED)
+      return _fixed_width;
+
+    return _arena.size(reason);
+  }
+
+  inline uint32_t _abstractLevel(uint32_t var) const {
+    return 1u << (_levels[var] & 31);
+  }
+
+  // undoes every assignment above decision level level
+  void _backtrack(uint32_t level);
+
+  // returns the unassigned literal to branch on, or NONE if all vars are assigned
+  uint32_t _pickBranch();
+
+  // local search over the input clauses starting from the given phases, which are
+  // replaced by the assignment with the fewest falsified clauses found. does nothing
+  // when lean, and stops early once a limit is reached.
+  void _walk(std::vector<int8_t> &phases);
+
+  // returns the number of distinct decision levels among lits
+  uint32_t _computeLbd(const uint32_t *lits, size_t size);
+
+  // deletes the learned clauses selected by the clause database policy. returns false
+  // if a limit is reached first, leaving watches of deleted clauses behind: the search
+  // must then stop.
+  bool _reduceDB();
+
+  // lays out the watch and implication lists back to back again, reclaiming the
+  // regions the lists that grew moved out of
+  void _compactLists();
+
+  // compacts the arena: moves the live clauses into a fresh arena in watch list order
+  // and rewrites every clause reference
+  void _collectGarbage();
+
+  // returns true if cref is the reason of a current assignment
+  bool _locked(cref_t cref) const;
+
+  inline int8_t _value(uint32_t lit) const {
+    int8_t v = _vals[lit >> 1];
+    return (lit & 1) ? -v : v;
+  }
+
+  inline uint32_t _decisionLevel() const { return _trail_lim.size(); }
+
+  static const uint32_t NONE = UINT32_MAX;
+  // reason (and conflict) marker of assignments implied by binary clauses
+  static const cref_t BINARY = ClauseArena::NONE - 1;
+  // reasons from FIXED up to BINARY refer to fixed-width clause FIXED + index, above
+  // every arena reference
+  static const cref_t FIXED = ClauseArena::LIMIT;
+
+  // number of variables, var v is stored at index v - 1 (see CNF::encode)
+  size_t _num_vars;
+
+  // whether the instance is large enough (see Limits::lean), or the memory budget
+  // tight enough, to skip the auxiliary structures: the normalized copy of the input
+  // and the occurrence lists of the walk
+  bool _lean;
+
+  ClauseArena _arena;
+  std::vector<cref_t> _clauses;
+  std::vector<cref_t> _learnts;
+
+  // lit -> clauses watching lit, visited when lit becomes false. the lists of all
+  // literals share one pool (likewise for _fixed_watches and _binaries), compacted by
+  // _compactLists.
+  ListPool<_Watch> _watches;
+
+  // input clauses of width _fixed_width (if nonzero) stored back to back without
+  // headers, and lit -> indices of the fixed-width clauses watching lit
+  uint32_t _fixed_width;
+  HugeVector<uint32_t> _fixed;
+  ListPool<_Watch> _fixed_watches;
+
+  // lit -> literals implied when lit becomes false, i.e. the other literals of the
+  // binary clauses containing lit. binary clauses have no other representation.
+  ListPool<uint32_t> _binaries;
+  // var -> binary clause that implied it, when its reason is BINARY
+  std::vector<std::array<uint32_t, 2>> _reason_bins;
+  // the falsified binary clause when propagation returns BINARY
+  std::array<uint32_t, 2> _conflict_bin;
+
+  // var -> 1 (true), -1 (false) or 0 (unassigned)
+  std::vector<int8_t> _vals;
+  std::vector<uint32_t> _levels;
+  std::vector<cref_t> _reasons;
+
+  std::vector<uint32_t> _trail;
+  // trail size at the start of every decision level
+  std::vector<size_t> _trail_lim;
+  // next trail position to propagate through long clauses, and through binary clauses
+  size_t _qhead;
+  size_t _bin_qhead;
+
+  // search statistics, checked against the limits at every decision
+  uint64_t _conflicts;
+  uint64_t _decisions;
+  uint64_t _propagations;
+
+  // random source of local search
+  std::mt19937 _rng;
+
+  // scratch state of conflict analysis
+  std::vector<uint8_t> _seen;
+  std::vector<uint32_t> _learnt;
+  // literals marked seen during minimization, and its explicit recursion stack
+  std::vector<uint32_t> _to_clear;
+  std::vector<uint32_t> _stack;
+  // antecedents to strengthen once the conflict is resolved
+  std::vector<cref_t> _strengthen;
+  std::vector<uint64_t> _level_stamp;
+  uint64_t _stamp;
+
+  Decision _decision;
+  Restart _restarts;
+  Phase _phases;
+  ClauseDB _db;
+  Tracer _tracer;
+};
+
+// the default configuration
+typedef CDCLEngine<VSIDS, ModeSwitchRestart, TargetPhases, TieredDB, NoTracer> CDCLSolver;
+
+// returns a new clause-learning solver with the given restart policy ("luby", "glucose"
+// or "stable") and phase policy ("target" or "saved"), writing a DRAT proof to proof
+// unless it is null. returns nullptr if a policy is unknown.
+Solver *makeCDCLSolver(const std::string &restart, const std::string &phase, std::ostream *proof);
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef CCSAT_CLAUSE_ARENA_H
+#define CCSAT_CLAUSE_ARENA_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "HugePages.h"
+
+namespace ccsat {
+
+// reference to a clause in a ClauseArena, i.e. the offset of its header. 32 bits by
+// default, which limits the arena to 2^31 words (8 GB); build with -DCCSAT_CREF64 for
+// larger instances, at the cost of larger watch lists.
+#ifdef CCSAT_CREF64
+typedef uint64_t cref_t;
+#else
+typedef uint32_t cref_t;
+#endif
+
+// hints the processor to start loading the cache line at addr, for memory that will be
+// read shortly. compiled out with -DCCSAT_NO_PREFETCH, to measure its effect.
+inline void prefetch(const void *addr) {
+#ifndef CCSAT_NO_PREFETCH
+  __builtin_prefetch(addr);
+#else
+  (void) addr;
+#endif
+}
+
+// tiers of learned clauses, by decreasing quality
+enum Tier { CORE = 0, TIER2 = 1, LOCAL = 2 };
+
+// contiguous storage for the clauses of the clause-learning engine. every clause is a
+// fixed-size header followed by its literals, so a clause is a single allocation and
+// clauses are addressed by cref_t offsets rather than pointers.
+class ClauseArena {
+ public:
+  // the null clause reference
+  static const cref_t NONE = ~cref_t(0);
+
+  // every clause reference is below LIMIT, the references from LIMIT up are free for
+  // the engine to use as markers
+  static const cref_t LIMIT = cref_t(1) << (8 * sizeof(cref_t) - 1);
+
+  // appends a clause with the given literals and returns its reference
+  // nb: throws std::length_error if the arena would outgrow the reference width
+  inline cref_t alloc(const std::vector<uint32_t> &lits, bool learnt) {
+    if (_data.size() + HEADER + lits.size() > LIMIT)
+      throw std::length_error("clause arena exceeds the clause reference width");
+
+    cref_t cref = static_cast<cref_t>(_data.size());
+
+    _data.push_back(static_cast<uint32_t>(lits.size()));
+    _data.push_back(learnt ? LEARNT : 0);
+    _data.push_back(0);
+    _data.push_back(2);
+    _data.insert(_data.end(), lits.begin(), lits.end());
+
+    return cref;
+  }
+
+  inline uint32_t size(cref_t cref) const { return _data[cref]; }
+
+  inline uint32_t *lits(cref_t cref) { return &_data[cref + HEADER]; }
+  inline const uint32_t *lits(cref_t cref) const { return &_data[cref + HEADER]; }
+
+  // prefetches the header and the first literals of cref
+  inline void prefetch(cref_t cref) const { ccsat::prefetch(&_data[cref]); }
+
+  inline bool learnt(cref_t cref) const { return _data[cref + 1] & LEARNT; }
+
+  inline bool deleted(cref_t cref) const { return _data[cref + 1] & DELETED; }
+
+  // marks cref deleted, its memory is wasted until the arena is compacted
+  inline void free(cref_t cref) {
+    _data[cref + 1] |= DELETED;
+    _wasted += HEADER + size(cref);
+  }
+
+  // position among the unwatched literals where the last replacement watch was found,
+  // where the next search resumes
+  inline uint32_t searchPos(cref_t cref) const { return _data[cref + 3]; }
+  inline void setSearchPos(cref_t cref, uint32_t pos) { _data[cref + 3] = pos; }
+
+  // drops the literals of cref past the given size
+  inline void shrink(cref_t cref, uint32_t size) {
+    _wasted += _data[cref] - size;
+    _data[cref] = size;
+  }
+
+  // set when the clause took part in conflict analysis since the last reduction
+  inline bool used(cref_t cref) const { return _data[cref + 1] & USED; }
+  inline void setUsed(cref_t cref, bool used) {
+    _data[cref + 1] = used ? (_data[cref + 1] | USED) : (_data[cref + 1] & ~USED);
+  }
+
+  inline Tier tier(cref_t cref) const {
+    return static_cast<Tier>((_data[cref + 1] & TIER_MASK) >> TIER_SHIFT);
+  }
+
+  inline void setTier(cref_t cref, Tier tier) {
+    _data[cref + 1] = (_data[cref + 1] & ~TIER_MASK) | (tier << TIER_SHIFT);
+  }
+
+  inline uint32_t lbd(cref_t cref) const { return _data[cref + 1] >> LBD_SHIFT; }
+
+  inline void setLbd(cref_t cref, uint32_t lbd) {
+    _data[cref + 1] = (_data[cref + 1] & FLAGS) | (lbd << LBD_SHIFT);
+  }
+
+  inline float activity(cref_t cref) const {
+    float activity;
+    std::memcpy(&activity, &_data[cref + 2], sizeof(activity));
+    return activity;
+  }
+
+  inline void setActivity(cref_t cref, float activity) {
+    std::memcpy(&_data[cref + 2], &activity, sizeof(activity));
+  }
+
+  // copies cref into to (once) and returns its new reference. the old clause keeps a
+  // forwarding reference, so relocating it again returns the same copy.
+  inline cref_t relocate(cref_t cref, ClauseArena &to) {
+    // the forwarding reference takes the activity and search position words
+    if (_data[cref + 1] & RELOCATED) {
+      cref_t moved;
+      std::memcpy(&moved, &_data[cref + 2], sizeof(moved));
+      return moved;
+    }
+
+    cref_t moved = static_cast<cref_t>(to._data.size());
+    to._data.insert(to._data.end(), &_data[cref], &_data[cref + HEADER + size(cref)]);
+
+    _data[cref + 1] |= RELOCATED;
+    std::memcpy(&_data[cref + 2], &moved, sizeof(moved));
+
+    return moved;
+  }
+
+  // total words in use, including those of deleted clauses
+  inline size_t words() const { return _data.size(); }
+
+  // words of deleted clauses, reclaimed by compaction
+  inline size_t wasted() const { return _wasted; }
+
+  // bytes allocated for the arena
+  inline size_t bytes() const { return _data.capacity() * sizeof(uint32_t); }
+
+  inline void reserve(size_t words) { _data.reserve(words); }
+
+  inline void clear() {
+    _data.clear();
+    _wasted = 0;
+  }
+
+  // returns the number of words a clause of size literals takes in the arena
+  static inline size_t words(size_t size) { return HEADER + size; }
+
+ private:
+  // header words preceding the literals of a clause: size, flags and LBD, activity,
+  // search position
+  static const uint32_t HEADER = 4;
+
+  // layout of the second header word: flag bits, the tier, then the LBD
+  static const uint32_t LEARNT = 1;
+  static const uint32_t DELETED = 2;
+  static const uint32_t USED = 4;
+  static const uint32_t RELOCATED = 8;
+  static const uint32_t TIER_SHIFT = 4;
+  static const uint32_t TIER_MASK = 3 << TIER_SHIFT;
+  static const uint32_t FLAGS = (1 << 6) - 1;
+  static const uint32_t LBD_SHIFT = 6;
+
+  HugeVector<uint32_t> _data;
+  size_t _wasted = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef CCSAT_CLAUSE_DB_H
+#define CCSAT_CLAUSE_DB_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "ClauseArena.h"
+
+namespace ccsat {
+
+// learned clause database policies of the clause-learning engine: the metadata kept
+// for learned clauses, and which of them are deleted when the database is reduced.
+
+// tiered database: learned clauses with LBD up to CORE_LBD are kept forever, up to
+// TIER2_LBD they are kept while they keep being used, and reductions delete the worse
+// half (by LBD, then activity) of the unused local clauses.
+class TieredDB {
+ public:
+  inline void init() {
+    _cla_inc = 1;
+    _reductions = 0;
+    _next_reduce = REDUCE_FIRST;
+  }
+
+  // sets the metadata of a newly learned clause
+  inline void learnt(ClauseArena &arena, cref_t cref, uint32_t lbd) {
+    arena.setLbd(cref, lbd);
+    arena.setTier(cref, _tierFor(lbd));
+    arena.setActivity(cref, static_cast<float>(_cla_inc));
+  }
+
+  // bumps a learned clause involved in a conflict: activity, usage and LBD (which may
+  // promote it to a better tier). lbd computes the current LBD of the clause.
+  template <class Lbd>
+  inline void bump(ClauseArena &arena, cref_t cref, const std::vector<cref_t> &learnts, Lbd lbd) {
+    float activity = arena.activity(cref) + static_cast<float>(_cla_inc);
+    arena.setActivity(cref, activity);
+
+    if (activity > CLAUSE_ACTIVITY_LIMIT) {
+      for (auto learnt : learnts)
+        arena.setActivity(learnt, arena.activity(learnt) / CLAUSE_ACTIVITY_LIMIT);
+
+      _cla_inc /= CLAUSE_ACTIVITY_LIMIT;
+    }
+
+    arena.setUsed(cref, true);
+
+    if (arena.tier(cref) == CORE)
+      return;
+
+    // every literal of a clause in conflict analysis is assigned, so its LBD can be
+    // recomputed, and only ever improves
+    uint32_t current = lbd(cref);
+    if (current < arena.lbd(cref)) {
+      arena.setLbd(cref, current);
+
+      if (_tierFor(current) < arena.tier(cref))
+        arena.setTier(cref, _tierFor(current));
+    }
+  }
+
+  // called once per conflict
+  inline void decay() { _cla_inc /= CLAUSE_DECAY; }
+
+  inline bool shouldReduce(uint64_t conflicts) const { return conflicts >= _next_reduce; }
+
+  // demotes unused tier2 clauses and frees the worse half of the local tier, except
+  // the clauses for which locked returns true
+  template <class Locked>
+  inline void reduce(ClauseArena &arena, const std::vector<cref_t> &learnts, uint64_t conflicts,
+      Locked locked) {
+    std::vector<cref_t> candidates;
+
+    for (auto cref : learnts) {
+      Tier tier = arena.tier(cref);
+      bool used = arena.used(cref);
+      arena.setUsed(cref, false);
+
+      if (tier == CORE || used)
+        continue;
+
+      // tier2 clauses get one more round in the local tier before they can be deleted
+      if (tier == TIER2) {
+        arena.setTier(cref, LOCAL);
+        continue;
+      }
+
+      if (!locked(cref))
+        candidates.push_back(cref);
+    }
+
+    // worst clauses first: highest LBD, then lowest activity
+    std::sort(candidates.begin(), candidates.end(),
+        [&arena](cref_t a, cref_t b) {
+          if (arena.lbd(a) != arena.lbd(b))
+            return arena.lbd(a) > arena.lbd(b);
+
+          return arena.activity(a) < arena.activity(b);
+        });
+
+    for (size_t i = 0; i < candidates.size() / 2; ++i)
+      arena.free(candidates[i]);
+
+    ++_reductions;
+    _next_reduce = conflicts + REDUCE_FIRST + _reductions * REDUCE_INC;
+  }
+
+ private:
+  static const uint32_t CORE_LBD = 2;
+  static const uint32_t TIER2_LBD = 6;
+
+  // conflicts before the first reduction, and the increment between reductions
+  static const uint64_t REDUCE_FIRST = 2000;
+  static const uint64_t REDUCE_INC = 300;
+
+  // activity decay factor and rescaling bound
+  static constexpr double CLAUSE_DECAY = 0.999;
+  static constexpr double CLAUSE_ACTIVITY_LIMIT = 1e20;
+
+  inline Tier _tierFor(uint32_t lbd) const {
+    if (lbd <= CORE_LBD)
+      return CORE;
+
+    return (lbd <= TIER2_LBD) ? TIER2 : LOCAL;
+  }
+
+  // activity increment, and the reduction schedule
+  double _cla_inc;
+  uint64_t _reductions;
+  uint64_t _next_reduce;
+};
+
+}
+
+#endif
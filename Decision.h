@@ -0,0 +1,140 @@
+#ifndef CCSAT_DECISION_H
+#define CCSAT_DECISION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Memory.h"
+
+namespace ccsat {
+
+// decision heuristics of the clause-learning engine. a heuristic picks the next
+// variable to branch on, and is told about the variables involved in conflicts.
+
+// VSIDS: every variable involved in a conflict is bumped by an increment that grows
+// geometrically, so recent conflicts weigh more. unassigned variables are kept in a
+// binary max-heap ordered by activity.
+class VSIDS {
+ public:
+  // marker of an exhausted heap, and of variables not in it
+  static const uint32_t NONE = UINT32_MAX;
+
+  inline void init(size_t num_vars) {
+    _activity.assign(num_vars, 0);
+    _inc = 1;
+    _heap.clear();
+    _pos.assign(num_vars, NONE);
+
+    for (uint32_t var = 0; var < num_vars; ++var)
+      _insert(var);
+  }
+
+  inline size_t bytes() const { return bytesOf(_activity) + bytesOf(_heap) + bytesOf(_pos); }
+
+  inline void bump(uint32_t var) {
+    if ((_activity[var] += _inc) > ACTIVITY_LIMIT) {
+      for (auto &activity : _activity)
+        activity /= ACTIVITY_LIMIT;
+
+      _inc /= ACTIVITY_LIMIT;
+    }
+
+    if (_contains(var))
+      _up(_pos[var]);
+  }
+
+  // called once per conflict
+  inline void decay() { _inc /= VAR_DECAY; }
+
+  // called when var becomes unassigned, making it a candidate again
+  inline void unassigned(uint32_t var) {
+    if (!_contains(var))
+      _insert(var);
+  }
+
+  // returns the most active unassigned var (vals[var] == 0), or NONE
+  inline uint32_t next(const std::vector<int8_t> &vals) {
+    while (!_heap.empty()) {
+      uint32_t var = _pop();
+
+      if (vals[var] == 0)
+        return var;
+    }
+
+    return NONE;
+  }
+
+ private:
+  // activity decay factor and the bound above which activities are rescaled
+  static constexpr double VAR_DECAY = 0.95;
+  static constexpr double ACTIVITY_LIMIT = 1e100;
+
+  inline bool _contains(uint32_t var) const { return _pos[var] != NONE; }
+
+  inline void _insert(uint32_t var) {
+    _pos[var] = _heap.size();
+    _heap.push_back(var);
+    _up(_heap.size() - 1);
+  }
+
+  inline uint32_t _pop() {
+    uint32_t top = _heap[0];
+
+    _heap[0] = _heap.back();
+    _pos[_heap[0]] = 0;
+    _heap.pop_back();
+    _pos[top] = NONE;
+
+    if (!_heap.empty())
+      _down(0);
+
+    return top;
+  }
+
+  inline void _up(size_t i) {
+    uint32_t var = _heap[i];
+
+    while (i > 0) {
+      size_t parent = (i - 1) / 2;
+      if (_activity[_heap[parent]] >= _activity[var])
+        break;
+
+      _heap[i] = _heap[parent];
+      _pos[_heap[i]] = i;
+      i = parent;
+    }
+
+    _heap[i] = var;
+    _pos[var] = i;
+  }
+
+  inline void _down(size_t i) {
+    uint32_t var = _heap[i];
+
+    while (2 * i + 1 < _heap.size()) {
+      size_t child = 2 * i + 1;
+      if (child + 1 < _heap.size() && _activity[_heap[child + 1]] > _activity[_heap[child]])
+        ++child;
+
+      if (_activity[_heap[child]] <= _activity[var])
+        break;
+
+      _heap[i] = _heap[child];
+      _pos[_heap[i]] = i;
+      i = child;
+    }
+
+    _heap[i] = var;
+    _pos[var] = i;
+  }
+
+  std::vector<double> _activity;
+  double _inc;
+  std::vector<uint32_t> _heap;
+  // var -> position in the heap, or NONE
+  std::vector<uint32_t> _pos;
+};
+
+}
+
+#endif
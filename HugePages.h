@@ -0,0 +1,130 @@
+#ifndef CCSAT_HUGE_PAGES_H
+#define CCSAT_HUGE_PAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace ccsat {
+
+// size of a huge page, allocations at least this large are mapped directly so that
+// they can be backed by huge pages
+static const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+// whether large allocations ask for huge pages (on by default), see setHugePages
+inline bool &hugePagesFlag() {
+  static bool enabled = true;
+  return enabled;
+}
+
+inline bool hugePages() { return hugePagesFlag(); }
+
+// enables or disables huge pages for allocations made from now on
+inline void setHugePages(bool enabled) { hugePagesFlag() = enabled; }
+
+// maps bytes (a multiple of HUGE_PAGE_SIZE) of memory aligned to a huge page. when huge
+// pages are enabled, the memory is taken from the reserved huge pages if there are
+// any (MAP_HUGETLB), else transparent huge pages are requested for it (MADV_HUGEPAGE).
+// either way falls back to normal pages silently.
+inline void *mapHuge(size_t bytes) {
+#ifdef __linux__
+#ifdef MAP_HUGETLB
+  if (hugePages()) {
+    void *addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED)
+      return addr;
+  }
+#endif
+
+  // over-map by a huge page, and trim to an aligned region: transparent huge pages
+  // only back aligned ones
+  size_t mapped = bytes + HUGE_PAGE_SIZE;
+  void *addr = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED)
+    throw std::bad_alloc();
+
+  uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+  uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~uintptr_t(HUGE_PAGE_SIZE - 1);
+  if (aligned != start)
+    munmap(addr, aligned - start);
+  if (aligned + bytes != start + mapped)
+    munmap(reinterpret_cast<void *>(aligned + bytes), start + mapped - aligned - bytes);
+
+#ifdef MADV_HUGEPAGE
+  if (hugePages())
+    madvise(reinterpret_cast<void *>(aligned), bytes, MADV_HUGEPAGE);
+#endif
+
+  return reinterpret_cast<void *>(aligned);
+#else
+  return ::operator new(bytes);
+#endif
+}
+
+inline void unmapHuge(void *addr, size_t bytes) {
+#ifdef __linux__
+  munmap(addr, bytes);
+#else
+  (void) bytes;
+  ::operator delete(addr);
+#endif
+}
+
+// allocator mapping allocations of at least HUGE_PAGE_SIZE with mapHuge, and taking
+// smaller ones from the heap. meant for the large arrays of the clause-learning engine
+// (clause storage, watch and implication lists), where TLB misses add up.
+template <class T>
+class HugePageAllocator {
+ public:
+  typedef T value_type;
+
+  HugePageAllocator() {}
+
+  template <class U>
+  HugePageAllocator(const HugePageAllocator<U> &) {}
+
+  inline T *allocate(size_t n) {
+    size_t bytes = n * sizeof(T);
+    if (bytes < HUGE_PAGE_SIZE)
+      return static_cast<T *>(::operator new(bytes));
+
+    return static_cast<T *>(mapHuge(_round(bytes)));
+  }
+
+  inline void deallocate(T *p, size_t n) {
+    size_t bytes = n * sizeof(T);
+    if (bytes < HUGE_PAGE_SIZE)
+      ::operator delete(p);
+    else
+      unmapHuge(p, _round(bytes));
+  }
+
+ private:
+  static inline size_t _round(size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+  }
+};
+
+template <class T, class U>
+inline bool operator==(const HugePageAllocator<T> &, const HugePageAllocator<U> &) {
+  return true;
+}
+
+template <class T, class U>
+inline bool operator!=(const HugePageAllocator<T> &, const HugePageAllocator<U> &) {
+  return false;
+}
+
+// a vector whose storage may be backed by huge pages once it is large enough
+template <class T>
+using HugeVector = std::vector<T, HugePageAllocator<T>>;
+
+}
+
+#endif
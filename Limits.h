@@ -0,0 +1,169 @@
+#ifndef CCSAT_LIMITS_H
+#define CCSAT_LIMITS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ccsat {
+
+// resource limits of a solve, 0 for none. a solver gives up with UNKNOWN once it
+// reaches any of them.
+struct Limits {
+  // wall time in seconds
+  double time = 0;
+  uint64_t conflicts = 0;
+  uint64_t decisions = 0;
+  // propagation ticks, i.e. literals assigned or propagated by the engine
+  uint64_t propagations = 0;
+  // memory budget in bytes, see Solver::memoryUsage. engines degrade as they approach it,
+  // and give up with UNKNOWN rather than exceed it.
+  size_t memory = 0;
+  // estimated footprint in bytes above which the engines run lean, i.e. skip auxiliary
+  // structures they can do without. 0 for half the physical memory.
+  size_t lean = 0;
+};
+
+// statistics of a running solve, as reported to progress callbacks
+struct Stats {
+  uint64_t conflicts = 0;
+  uint64_t decisions = 0;
+  uint64_t propagations = 0;
+  // wall time spent solving in seconds, not counting the time between slices
+  double seconds = 0;
+};
+
+// called with the statistics of a running solve, from the thread running it
+typedef std::function<void(const Stats &)> ProgressCallback;
+
+// checks the progress of a solve against its Limits and a termination flag, and
+// reports it to a progress callback. meant to be called from the main loop of an
+// engine: the counters and the flag are checked on every call, the clock is only read
+// every CLOCK_INTERVAL calls (and only if there is a time limit or a callback). once a
+// limit is reached, every later call returns true.
+//
+// a resumable solve also runs in slices of propagation ticks: yield is checked at the
+// points the search can be resumed from, and is true at the end of the slice as well.
+// the clock only runs between start or slice and the next pause, so the time limit
+// bounds the time spent on the solve itself.
+class LimitCheck {
+ public:
+  // starts the clock of a solve under limits. the solve stops once terminate is set,
+  // and progress (unless empty) is called about every interval seconds.
+  // nb: terminate must outlive the solve
+  inline void start(const Limits &limits, const std::atomic<bool> *terminate,
+      const ProgressCallback &progress, double interval) {
+    _limits = limits;
+    _terminate = terminate;
+    _progress = progress;
+    _interval = interval;
+    _calls = 0;
+    _reached = false;
+    _slice_ticks = 0;
+    _slice_end = 0;
+    _yielded = false;
+    _elapsed = 0;
+    _resumed = std::chrono::steady_clock::now();
+    _next_progress = interval;
+  }
+
+  // returns the limits of the solve
+  inline const Limits &limits() const { return _limits; }
+
+  // stops the clock, until the next slice
+  inline void pause() {
+    std::chrono::duration<double> run = std::chrono::steady_clock::now() - _resumed;
+    _elapsed += run.count();
+  }
+
+  // returns true if any limit is reached, or termination was asked for
+  inline bool reached(uint64_t conflicts, uint64_t decisions, uint64_t propagations) {
+    if (_limits.conflicts != 0 && conflicts >= _limits.conflicts)
+      _reached = true;
+    if (_limits.decisions != 0 && decisions >= _limits.decisions)
+      _reached = true;
+    if (_limits.propagations != 0 && propagations >= _limits.propagations)
+      _reached = true;
+    if (_terminate->load(std::memory_order_relaxed))
+      _reached = true;
+
+    if ((_limits.time > 0 || _progress) && ++_calls % CLOCK_INTERVAL == 0)
+      _tick(conflicts, decisions, propagations);
+
+    return _reached;
+  }
+
+  // restarts the clock, with a slice of about ticks propagations, or no slice if ticks
+  // is 0. the slice is counted from the first yield.
+  inline void slice(uint64_t ticks) {
+    _slice_ticks = ticks;
+    _slice_end = 0;
+    _yielded = false;
+    _resumed = std::chrono::steady_clock::now();
+  }
+
+  // returns true if any limit is reached, or the slice is over
+  inline bool yield(uint64_t conflicts, uint64_t decisions, uint64_t propagations) {
+    if (reached(conflicts, decisions, propagations))
+      return true;
+
+    if (_slice_ticks == 0)
+      return false;
+
+    if (_slice_end == 0)
+      _slice_end = propagations + _slice_ticks;
+
+    _yielded = propagations >= _slice_end;
+    return _yielded;
+  }
+
+  // returns true if the last yield returned true only because the slice was over
+  inline bool yielded() const { return _yielded; }
+
+ private:
+  // calls between two reads of the clock
+  static const uint64_t CLOCK_INTERVAL = 256;
+
+  // reads the clock, checking the time limit and reporting progress when it is due
+  inline void _tick(uint64_t conflicts, uint64_t decisions, uint64_t propagations) {
+    std::chrono::duration<double> run = std::chrono::steady_clock::now() - _resumed;
+    const double elapsed = _elapsed + run.count();
+
+    if (_limits.time > 0 && elapsed >= _limits.time)
+      _reached = true;
+
+    if (_progress && elapsed >= _next_progress) {
+      Stats stats;
+      stats.conflicts = conflicts;
+      stats.decisions = decisions;
+      stats.propagations = propagations;
+      stats.seconds = elapsed;
+      _progress(stats);
+
+      _next_progress = elapsed + _interval;
+    }
+  }
+
+  Limits _limits;
+  const std::atomic<bool> *_terminate = nullptr;
+  ProgressCallback _progress;
+  double _interval = 0;
+  uint64_t _calls = 0;
+  bool _reached = false;
+  // propagations of the slice, and the count at which it ends once known (0 before the
+  // first yield of the slice)
+  uint64_t _slice_ticks = 0;
+  uint64_t _slice_end = 0;
+  bool _yielded = false;
+  // solving time of the previous runs in seconds, and the start of the current one
+  double _elapsed = 0;
+  std::chrono::steady_clock::time_point _resumed;
+  // solve time at which progress is reported next
+  double _next_progress = 0;
+};
+
+}
+
+#endif
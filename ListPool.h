@@ -0,0 +1,131 @@
+#ifndef CCSAT_LIST_POOL_H
+#define CCSAT_LIST_POOL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "HugePages.h"
+#include "Memory.h"
+
+namespace ccsat {
+
+// one list of T entries per key (e.g. watches per literal), all stored in a single
+// pool that is backed by huge pages once it is large enough, so that the entries
+// visited during propagation do not each cost a TLB entry of their own. every key has
+// a small header with the position, size and capacity of its region of the pool. a
+// list that outgrows its region moves to a region twice the size at the end of the
+// pool, leaving its old region unused until compact lays the lists out again back to
+// back in key order.
+//
+// nb: pushing to any list may move the pool, invalidating pointers into every list.
+//     positions within a list stay valid.
+template <class T>
+class ListPool {
+ public:
+  // a contiguous range of entries, the list of a key
+  struct Span {
+    T *first;
+    T *last;
+
+    inline T *begin() const { return first; }
+    inline T *end() const { return last; }
+    inline size_t size() const { return last - first; }
+    inline bool empty() const { return first == last; }
+    inline T &operator[](size_t i) const { return first[i]; }
+  };
+
+  // clears everything and makes room for keys 0 .. num_keys - 1. the pool keeps its
+  // capacity for the next instance.
+  inline void init(size_t num_keys) {
+    _headers.assign(num_keys, _Header());
+    _pool.clear();
+    _wasted = 0;
+  }
+
+  inline size_t numKeys() const { return _headers.size(); }
+
+  // returns the bytes of the header of a key
+  static inline size_t headerBytes() { return sizeof(_Header); }
+
+  inline size_t size(size_t key) const { return _headers[key].size; }
+
+  inline Span operator[](size_t key) {
+    T *first = _pool.data() + _headers[key].offset;
+    return {first, first + _headers[key].size};
+  }
+
+  inline void push(size_t key, const T &entry) {
+    _Header &header = _headers[key];
+
+    if (header.size == header.capacity) {
+      const uint32_t capacity = std::max(MIN_CAPACITY, 2 * header.capacity);
+      const size_t offset = _pool.size();
+      _pool.resize(offset + capacity);
+      std::copy(_pool.begin() + header.offset, _pool.begin() + header.offset + header.size,
+          _pool.begin() + offset);
+
+      _wasted += header.capacity;
+      header.offset = offset;
+      header.capacity = capacity;
+    }
+
+    _pool[header.offset + header.size++] = entry;
+  }
+
+  // truncates the list of key to its first size entries
+  inline void shrink(size_t key, size_t size) { _headers[key].size = static_cast<uint32_t>(size); }
+
+  // entries of the pool in regions no list uses any more
+  inline size_t wasted() const { return _wasted; }
+
+  // moves the lists into a fresh pool, back to back in key order, each with a little
+  // room to grow
+  inline void compact() {
+    size_t total = 0;
+    for (const auto &header : _headers)
+      total += _room(header.size);
+
+    HugeVector<T> to;
+    to.reserve(total);
+
+    for (auto &header : _headers) {
+      const size_t offset = to.size();
+      to.insert(to.end(), _pool.begin() + header.offset,
+          _pool.begin() + header.offset + header.size);
+      to.resize(offset + _room(header.size));
+
+      header.offset = offset;
+      header.capacity = static_cast<uint32_t>(_room(header.size));
+    }
+
+    _pool = std::move(to);
+    _wasted = 0;
+  }
+
+  // returns the bytes allocated for the headers and the pool
+  inline size_t bytes() const { return bytesOf(_headers) + bytesOf(_pool); }
+
+ private:
+  // capacity of the region of a list when it first gets one
+  static const uint32_t MIN_CAPACITY = 4;
+
+  // returns the capacity a list of size entries gets when compacting
+  static inline size_t _room(size_t size) {
+    return (size == 0) ? 0 : std::max<size_t>(MIN_CAPACITY, size + size / 2);
+  }
+
+  struct _Header {
+    size_t offset = 0;
+    uint32_t size = 0;
+    uint32_t capacity = 0;
+  };
+
+  HugeVector<_Header> _headers;
+  HugeVector<T> _pool;
+  size_t _wasted = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,521 @@
+#include <algorithm>
+#include <vector>
+
+#include "Lookahead.h"
+
+namespace ccsat {
+
+// always probe at least this many candidates (when available)...
+static const size_t MIN_CANDIDATES = 20;
+// ...or this fraction of the free variables, whichever is larger
+static const double CANDIDATE_FRACTION = 0.1;
+
+// factor applied to the double lookahead trigger at every node, so that double
+// lookahead is retried after it stopped paying off
+static const double DL_DECAY = 0.9;
+
+// clauses longer than this weigh as much as a clause of this length, so that the weight
+// of a reduction stays positive (0.2^62 is far above the smallest double)
+static const size_t MAX_WEIGHT_LENGTH = 64;
+
+// search nodes between two checks of the memory budget
+static const uint64_t MEMORY_CHECK_INTERVAL = 256;
+
+void LookaheadSolver::_begin(const CNF &cnf) {
+  // give up before allocating if the instance cannot fit the memory budget
+  if (_footprint(cnf) > _maxMemory()) {
+    _finish(UNKNOWN);
+    return;
+  }
+
+  if (!_init(cnf)) {
+    _finish(UNSAT);
+    return;
+  }
+
+  if (_overBudget())
+    _finish(UNKNOWN);
+}
+
+Result LookaheadSolver::_resume() {
+  Result result = _search();
+  if (result == SAT) {
+    for (size_t i = 0; i < _num_vars; ++i)
+      _model[i + 1] = (_vals[i] == 1);
+  }
+
+  return result;
+}
+
+MemoryUsage LookaheadSolver::memoryUsage() const {
+  MemoryUsage usage;
+  usage.clauses = bytesOf(_lits) + bytesOf(_clause_start) + bytesOf(_clause_size)
+      + bytesOf(_num_false) + bytesOf(_num_true);
+  usage.lists = bytesOf(_occs);
+  for (const auto &occs : _occs)
+    usage.lists += bytesOf(occs);
+  usage.vars = bytesOf(_vals) + bytesOf(_scores) + bytesOf(_failed_stamp);
+  usage.search = bytesOf(_trail) + bytesOf(_units) + bytesOf(_decisions) + bytesOf(_failed)
+      + bytesOf(_candidates) + bytesOf(_forest);
+
+  return usage;
+}
+
+size_t LookaheadSolver::_footprint(const CNF &cnf) const {
+  // the clause literals and their occurrences, the per-clause ranges and counters, and
+  // per variable its state and the occurrence lists of both literals
+  return cnf.numLiterals() * (sizeof(uint32_t) + sizeof(size_t))
+      + cnf.size() * (sizeof(size_t) + 3 * sizeof(uint32_t))
+      + size_t(cnf.maxVar()) * (2 * sizeof(std::vector<size_t>) + sizeof(int8_t)
+      + sizeof(double) + sizeof(uint64_t));
+}
+
+bool LookaheadSolver::_init(const CNF &cnf) {
+  _num_vars = cnf.maxVar();
+
+  const size_t num_lits = 2 * _num_vars;
+
+  _lits.clear();
+  _clause_start.clear();
+  _clause_size.clear();
+  _occs.assign(num_lits, std::vector<size_t>());
+  _vals.assign(_num_vars, 0);
+  _trail.clear();
+  _units.clear();
+  _conflict = false;
+  _decisions.clear();
+  _nodes = 0;
+  _branches = 0;
+  _conflicts = 0;
+  _propagations = 0;
+  _diff = 0;
+  _scores.assign(num_lits, 0);
+  _failed.clear();
+  _failed_stamp.assign(num_lits, 0);
+  _round = 0;
+  _dl_trigger = 0;
+
+  // store clauses without duplicate literals, dropping tautologies
+  std::vector<uint32_t> units;
+  std::vector<uint32_t> lits;
+  for (const auto &clause : cnf.clauses) {
+    if (!CNF::normalize(clause, lits))
+      continue;
+
+    if (lits.size() == 1)
+      units.push_back(lits[0]);
+
+    size_t c = _clause_start.size();
+    _clause_start.push_back(_lits.size());
+    _clause_size.push_back(lits.size());
+    for (auto lit : lits) {
+      _lits.push_back(lit);
+      _occs[lit].push_back(c);
+    }
+  }
+
+  _num_false.assign(_clause_start.size(), 0);
+  _num_true.assign(_clause_start.size(), 0);
+  _num_sat = 0;
+
+  // unit clauses are assigned before the first decision
+  for (auto lit : units) {
+    if (_value(lit) == 1)
+      continue;
+
+    if (_value(lit) == -1 || !_assume(lit))
+      return false;
+  }
+
+  return true;
+}
+
+Result LookaheadSolver::_search() {
+  while (true) {
+    if (_shouldYield(_conflicts, _branches, _propagations))
+      return UNKNOWN;
+    if (++_nodes % MEMORY_CHECK_INTERVAL == 0 && _overBudget())
+      return UNKNOWN;
+
+    uint32_t lit;
+    _Status status = _lookahead(&lit);
+
+    if (status == SATISFIED)
+      return SAT;
+    if (status == STOPPED)
+      return UNKNOWN;
+
+    if (status == CONFLICT) {
+      ++_conflicts;
+      if (!_backtrack())
+        return UNSAT;
+
+      continue;
+    }
+
+    _decisions.push_back({_trail.size(), lit, false});
+    ++_branches;
+    if (!_assume(lit)) {
+      ++_conflicts;
+      if (!_backtrack())
+        return UNSAT;
+    }
+  }
+}
+
+bool LookaheadSolver::_backtrack() {
+  while (!_decisions.empty()) {
+    _Decision &decision = _decisions.back();
+    _undoTo(decision.trail_pos);
+
+    if (!decision.flipped) {
+      decision.flipped = true;
+      decision.lit ^= 1;
+
+      if (_assume(decision.lit))
+        return true;
+
+      // the other branch fails immediately as well, keep unwinding
+      continue;
+    }
+
+    _decisions.pop_back();
+  }
+
+  return false;
+}
+
+LookaheadSolver::_Status LookaheadSolver::_lookahead(uint32_t *out) {
+  _dl_trigger *= DL_DECAY;
+
+  while (true) {
+    if (_satisfied())
+      return SATISFIED;
+
+    _preselect();
+    if (_candidates.empty())
+      return _fallback(out);
+
+    ++_round;
+    _failed.clear();
+
+    for (auto i : _buildForest()) {
+      if (_limitReached(_conflicts, _branches, _propagations))
+        return STOPPED;
+
+      if (!_lookTree(i, 0))
+        return SATISFIED;
+    }
+
+    if (_failed.empty())
+      break;
+
+    // every failed literal is refuted under the current node, assert its negation. a
+    // failed literal that became true in the meantime refutes the node itself.
+    for (auto lit : _failed) {
+      if (_value(lit) == 1)
+        return CONFLICT;
+
+      if (_value(lit) == 0 && !_assume(lit ^ 1))
+        return CONFLICT;
+    }
+  }
+
+  // pick the variable with the best product score, taking the branch that reduces
+  // the formula least first since it is the one more likely to be satisfiable
+  double best = -1;
+  for (auto var : _candidates) {
+    double pos = _scores[2 * var];
+    double neg = _scores[2 * var + 1];
+    double score = 1024 * pos * neg + pos + neg;
+
+    if (score > best) {
+      best = score;
+      *out = (pos <= neg) ? 2 * var : 2 * var + 1;
+    }
+  }
+
+  return BRANCH;
+}
+
+LookaheadSolver::_Status LookaheadSolver::_fallback(uint32_t *out) const {
+  for (size_t c = 0; c < _clause_start.size(); ++c) {
+    if (_num_true[c] != 0)
+      continue;
+
+    for (size_t k = _clause_start[c]; k < _clause_start[c] + _clause_size[c]; ++k) {
+      if (_value(_lits[k]) == 0) {
+        *out = _lits[k];
+        return BRANCH;
+      }
+    }
+
+    return CONFLICT;
+  }
+
+  return SATISFIED;
+}
+
+void LookaheadSolver::_preselect() {
+  // estimate the reduction of both polarities by the clauses each literal would shorten
+  std::vector<std::pair<double, uint32_t>> ranked;
+  for (uint32_t var = 0; var < _num_vars; ++var) {
+    if (!_free(var))
+      continue;
+
+    double reduces[2] = {0, 0};
+    for (uint32_t sign = 0; sign < 2; ++sign) {
+      // assigning var with this sign shortens the clauses containing its negation
+      for (auto c : _occs[2 * var + (sign ^ 1)]) {
+        if (_num_true[c] == 0)
+          reduces[sign] += _weight(_clause_size[c] - _num_false[c] - 1);
+      }
+    }
+
+    if (reduces[0] + reduces[1] == 0)
+      continue;
+
+    ranked.push_back({1024 * reduces[0] * reduces[1] + reduces[0] + reduces[1], var});
+  }
+
+  size_t count = std::max(MIN_CANDIDATES,
+      static_cast<size_t>(ranked.size() * CANDIDATE_FRACTION));
+  count = std::min(count, ranked.size());
+
+  std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+      [](const auto &a, const auto &b) {
+        return a.first > b.first;
+      });
+
+  _candidates.clear();
+  for (size_t i = 0; i < count; ++i) {
+    _candidates.push_back(ranked[i].second);
+    _scores[2 * ranked[i].second] = 0;
+    _scores[2 * ranked[i].second + 1] = 0;
+  }
+}
+
+std::vector<size_t> LookaheadSolver::_buildForest() {
+  _forest.clear();
+
+  // lit -> node index + 1, or 0 if lit is not a candidate
+  std::vector<size_t> node_of(2 * _num_vars, 0);
+  for (auto var : _candidates) {
+    for (uint32_t sign = 0; sign < 2; ++sign) {
+      _forest.push_back({2 * var + sign, {}});
+      node_of[2 * var + sign] = _forest.size();
+    }
+  }
+
+  // a binary clause (~a, b) means the lookahead on a includes the one on b, so a
+  // becomes a child of b (unless that would close a cycle)
+  std::vector<size_t> parent(_forest.size(), _forest.size());
+  for (size_t i = 0; i < _forest.size(); ++i) {
+    uint32_t lit = _forest[i].lit;
+
+    for (auto c : _occs[lit ^ 1]) {
+      if (_num_true[c] != 0 || _clause_size[c] - _num_false[c] != 2)
+        continue;
+
+      // find the other free literal of the binary clause
+      uint32_t other = lit ^ 1;
+      for (size_t k = _clause_start[c]; k < _clause_start[c] + _clause_size[c]; ++k) {
+        if (_lits[k] != (lit ^ 1) && _value(_lits[k]) == 0)
+          other = _lits[k];
+      }
+
+      if (other == (lit ^ 1) || node_of[other] == 0)
+        continue;
+
+      size_t p = node_of[other] - 1;
+      size_t ancestor = p;
+      while (ancestor != _forest.size() && ancestor != i)
+        ancestor = parent[ancestor];
+
+      if (ancestor == i)
+        continue;
+
+      parent[i] = p;
+      break;
+    }
+  }
+
+  std::vector<size_t> roots;
+  for (size_t i = 0; i < _forest.size(); ++i) {
+    if (parent[i] == _forest.size())
+      roots.push_back(i);
+    else
+      _forest[parent[i]].children.push_back(i);
+  }
+
+  return roots;
+}
+
+bool LookaheadSolver::_lookTree(size_t i, double base) {
+  uint32_t lit = _forest[i].lit;
+
+  if (_value(lit) == -1) {
+    // the ancestors imply ~lit, but lit implies its ancestors
+    if (_failed_stamp[lit] != _round) {
+      _failed_stamp[lit] = _round;
+      _failed.push_back(lit);
+    }
+
+    return true;
+  }
+
+  size_t pos = _trail.size();
+  double saved = _diff;
+  _diff = 0;
+
+  bool consistent = (_value(lit) == 1) || _assume(lit);
+  if (consistent && _satisfied())
+    return false;
+
+  if (consistent && _diff > _dl_trigger) {
+    double reduction = _diff;
+    size_t failed = _failed.size();
+
+    consistent = _doubleLook();
+    if (consistent && _satisfied())
+      return false;
+
+    // double lookahead did not pay off at this reduction, raise the bar
+    if (consistent && _failed.size() == failed)
+      _dl_trigger = reduction;
+  }
+
+  if (!consistent) {
+    _undoTo(pos);
+    _diff = saved;
+
+    if (_failed_stamp[lit] != _round) {
+      _failed_stamp[lit] = _round;
+      _failed.push_back(lit);
+    }
+
+    return true;
+  }
+
+  double score = base + _diff;
+  _scores[lit] = score;
+
+  for (auto child : _forest[i].children) {
+    if (!_lookTree(child, score))
+      return false;
+  }
+
+  _undoTo(pos);
+  _diff = saved;
+
+  return true;
+}
+
+bool LookaheadSolver::_doubleLook() {
+  for (auto var : _candidates) {
+    for (uint32_t sign = 0; sign < 2; ++sign) {
+      uint32_t lit = 2 * var + sign;
+      if (_value(lit) != 0)
+        continue;
+
+      size_t pos = _trail.size();
+      double saved = _diff;
+
+      bool consistent = _assume(lit);
+      if (consistent && _satisfied())
+        return true;
+
+      _undoTo(pos);
+      _diff = saved;
+
+      // lit fails under the current lookahead, so its negation is implied
+      if (!consistent && !_assume(lit ^ 1))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+void LookaheadSolver::_assign(uint32_t lit) {
+  _vals[lit >> 1] = (lit & 1) ? -1 : 1;
+  _trail.push_back(lit);
+  ++_propagations;
+
+  for (auto c : _occs[lit]) {
+    if (_num_true[c]++ == 0)
+      ++_num_sat;
+  }
+
+  for (auto c : _occs[lit ^ 1]) {
+    uint32_t num_false = ++_num_false[c];
+
+    if (_num_true[c] != 0)
+      continue;
+
+    size_t remaining = _clause_size[c] - num_false;
+    if (remaining == 0)
+      _conflict = true;
+    else if (remaining == 1)
+      _units.push_back(c);
+    else
+      _diff += _weight(remaining);
+  }
+}
+
+void LookaheadSolver::_undoTo(size_t pos) {
+  while (_trail.size() > pos) {
+    uint32_t lit = _trail.back();
+    _trail.pop_back();
+
+    for (auto c : _occs[lit]) {
+      if (--_num_true[c] == 0)
+        --_num_sat;
+    }
+
+    for (auto c : _occs[lit ^ 1])
+      --_num_false[c];
+
+    _vals[lit >> 1] = 0;
+  }
+}
+
+bool LookaheadSolver::_assume(uint32_t lit) {
+  _assign(lit);
+
+  return _propagate();
+}
+
+bool LookaheadSolver::_propagate() {
+  while (!_conflict && !_units.empty()) {
+    size_t c = _units.back();
+    _units.pop_back();
+
+    if (_num_true[c] != 0)
+      continue;
+
+    for (size_t k = _clause_start[c]; k < _clause_start[c] + _clause_size[c]; ++k) {
+      if (_value(_lits[k]) == 0) {
+        _assign(_lits[k]);
+        break;
+      }
+    }
+  }
+
+  bool consistent = !_conflict;
+  _units.clear();
+  _conflict = false;
+
+  return consistent;
+}
+
+double LookaheadSolver::_weight(size_t len) const {
+  // newly created binary clauses dominate, longer clauses count for much less
+  double weight = 1;
+  for (size_t i = 2; i < std::min(len, MAX_WEIGHT_LENGTH); ++i)
+    weight *= 0.2;
+
+  return weight;
+}
+
+}
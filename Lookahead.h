@@ -0,0 +1,155 @@
+#ifndef CCSAT_LOOKAHEAD_H
+#define CCSAT_LOOKAHEAD_H
+
+#include <cstdint>
+#include <vector>
+
+#include "SAT.h"
+
+namespace ccsat {
+
+// march-style lookahead DPLL. before every decision the solver preselects a set of
+// candidate variables, probes both polarities of each (sharing propagation along
+// binary implication trees), turns failed literals into forced assignments, and
+// branches on the variable with the best product of reductions.
+class LookaheadSolver : public Solver {
+ public:
+  MemoryUsage memoryUsage() const override;
+
+ protected:
+  void _begin(const CNF &cnf) override;
+  Result _resume() override;
+
+ private:
+  enum _Status { CONFLICT, BRANCH, SATISFIED, STOPPED };
+
+  // an entry of the chronological decision stack
+  struct _Decision {
+    // trail size before the decision was made
+    size_t trail_pos;
+    uint32_t lit;
+    // true once the opposite branch is being explored
+    bool flipped;
+  };
+
+  // a node of the lookahead forest: looking ahead on lit implies looking ahead on its
+  // parent, so children are probed on top of the parent's propagation
+  struct _LookNode {
+    uint32_t lit;
+    std::vector<size_t> children;
+  };
+
+  // initializes the solver on the given CNF SAT instance
+  // returns false if the instance is already refuted by its unit clauses
+  bool _init(const CNF &cnf);
+  Result _search();
+
+  // returns an estimate of the memory the solver takes for cnf, before allocating it
+  size_t _footprint(const CNF &cnf) const;
+
+  // backtracks chronologically to the most recent unflipped decision and flips it,
+  // returns false if the search space is exhausted
+  bool _backtrack();
+
+  // runs the lookahead procedure on the current node. on BRANCH, outputs the literal
+  // to try first through out. failed literals are assigned at the current node.
+  // returns STOPPED if a limit is reached in the meantime.
+  _Status _lookahead(uint32_t *out);
+
+  // decides the current node when no variable was preselected: BRANCH on a free literal
+  // (output through out) of an unsatisfied clause, CONFLICT if a clause is falsified,
+  // SATISFIED if every clause is satisfied
+  _Status _fallback(uint32_t *out) const;
+
+  // fills _candidates with the preselected free variables
+  void _preselect();
+
+  // builds the lookahead forest over both polarities of the candidates, returns roots
+  std::vector<size_t> _buildForest();
+
+  // probes the subtree rooted at node i on top of the current assignment, with base
+  // being the reduction already achieved by the ancestors. returns false if the whole
+  // formula was satisfied during the probe.
+  bool _lookTree(size_t i, double base);
+
+  // double lookahead: probes the candidates under the current lookahead literal,
+  // asserting the negation of every literal that fails. returns false on conflict.
+  bool _doubleLook();
+
+  // assigns lit and updates the clause counters, accumulating the reduction in _diff
+  void _assign(uint32_t lit);
+
+  // unassigns every literal above trail position pos
+  void _undoTo(size_t pos);
+
+  // assigns lit and propagates it, returns false on conflict
+  bool _assume(uint32_t lit);
+
+  // runs unit propagation over the pending unit clauses, returns false on conflict
+  bool _propagate();
+
+  // weight of a clause reduced to len remaining literals, used to measure reductions
+  double _weight(size_t len) const;
+
+  inline int8_t _value(uint32_t lit) const {
+    int8_t v = _vals[lit >> 1];
+    return (lit & 1) ? -v : v;
+  }
+
+  inline bool _free(uint32_t var) const { return _vals[var] == 0; }
+
+  inline bool _satisfied() const { return _num_sat == _clause_start.size(); }
+
+  // number of variables, var v is stored at index v - 1 (see CNF::encode)
+  size_t _num_vars;
+
+  // clause literals, clause i spans [_clause_start[i], _clause_start[i] + _clause_size[i])
+  std::vector<uint32_t> _lits;
+  std::vector<size_t> _clause_start;
+  std::vector<uint32_t> _clause_size;
+
+  // per-clause counters of false and true literals
+  std::vector<uint32_t> _num_false;
+  std::vector<uint32_t> _num_true;
+  // number of clauses with at least one true literal
+  size_t _num_sat;
+
+  // lit -> clauses containing lit
+  std::vector<std::vector<size_t>> _occs;
+
+  // var -> 1 (true), -1 (false) or 0 (unassigned)
+  std::vector<int8_t> _vals;
+  std::vector<uint32_t> _trail;
+  // clauses that became unit and still need to be propagated
+  std::vector<size_t> _units;
+  bool _conflict;
+
+  std::vector<_Decision> _decisions;
+  // search statistics, checked against the limits at every node and between the
+  // lookahead trees of a node. the memory budget is checked every
+  // MEMORY_CHECK_INTERVAL nodes.
+  uint64_t _nodes;
+  // decisions made, _decisions only holds the current ones
+  uint64_t _branches;
+  uint64_t _conflicts;
+  uint64_t _propagations;
+
+  // reduction accumulated since it was last reset
+  double _diff;
+  // lit -> reduction measured by the last lookahead on lit
+  std::vector<double> _scores;
+  // lits that failed during the current lookahead round
+  std::vector<uint32_t> _failed;
+  // lit -> round in which lit was found failed, to avoid duplicates
+  std::vector<uint64_t> _failed_stamp;
+  uint64_t _round;
+
+  std::vector<uint32_t> _candidates;
+  std::vector<_LookNode> _forest;
+  // reduction above which double lookahead is attempted, adapted during search
+  double _dl_trigger;
+};
+
+}
+
+#endif
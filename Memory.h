@@ -0,0 +1,47 @@
+#ifndef CCSAT_MEMORY_H
+#define CCSAT_MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace ccsat {
+
+// returns the physical memory of the machine in bytes, or SIZE_MAX if unknown
+inline size_t physicalMemory() {
+#ifdef __linux__
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long page_size = sysconf(_SC_PAGE_SIZE);
+  if (pages > 0 && page_size > 0)
+    return static_cast<size_t>(pages) * static_cast<size_t>(page_size);
+#endif
+
+  return SIZE_MAX;
+}
+
+// returns the bytes allocated for the elements of the vector v
+template <class V>
+inline size_t bytesOf(const V &v) {
+  return v.capacity() * sizeof(typename V::value_type);
+}
+
+// memory used by an engine in bytes, per subsystem
+struct MemoryUsage {
+  // clause storage, input and learned
+  size_t clauses = 0;
+  // watch, implication and occurrence lists
+  size_t lists = 0;
+  // per-variable state: assignment, heuristics, phases
+  size_t vars = 0;
+  // trail and search stacks
+  size_t search = 0;
+
+  inline size_t total() const { return clauses + lists + vars + search; }
+};
+
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef CCSAT_OCC_LISTS_H
+#define CCSAT_OCC_LISTS_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace ccsat {
+
+// one list of uint32_t entries per key (e.g. clause indices per literal). every key
+// has a header of one cache line holding the size of its list and, while it is short,
+// its entries, so a short list is a single load. longer lists spill into a shared
+// overflow region, which only grows: a list that outgrows its region moves to a new
+// one at the end. init empties the region but keeps its capacity for the next instance.
+// offsets into the region are 32 bits, so it holds at most OVERFLOW_LIMIT entries.
+class OccLists {
+ public:
+  // a contiguous range of entries
+  struct Range {
+    const uint32_t *first;
+    const uint32_t *last;
+
+    inline const uint32_t *begin() const { return first; }
+    inline const uint32_t *end() const { return last; }
+    inline size_t size() const { return last - first; }
+    inline bool empty() const { return first == last; }
+  };
+
+  // clears everything and makes room for keys 0 .. num_keys - 1
+  inline void init(size_t num_keys) {
+    _num_keys = num_keys;
+    _raw.reset(new char[(num_keys + 1) * sizeof(_Header)]);
+
+    // align the headers to cache lines by hand, new only guarantees fundamental
+    // alignment before C++17
+    uintptr_t addr = reinterpret_cast<uintptr_t>(_raw.get());
+    addr = (addr + sizeof(_Header) - 1) & ~uintptr_t(sizeof(_Header) - 1);
+    _headers = reinterpret_cast<_Header *>(addr);
+    std::memset(_headers, 0, num_keys * sizeof(_Header));
+
+    _overflow.clear();
+  }
+
+  inline void push(size_t key, uint32_t entry) {
+    _Header &header = _headers[key];
+
+    if (header.size < INLINE) {
+      header.inline_entries[header.size++] = entry;
+      return;
+    }
+
+    // spilling (or outgrowing the overflow region), move to a region twice the size
+    if (header.size == INLINE || header.size == header.capacity) {
+      uint32_t capacity = 2 * header.size;
+      if (_overflow.size() + capacity > OVERFLOW_LIMIT)
+        throw std::length_error("occurrence lists exceed 2^32 entries");
+
+      uint32_t offset = static_cast<uint32_t>(_overflow.size());
+      _overflow.resize(_overflow.size() + capacity);
+
+      const uint32_t *from = (header.size == INLINE) ? header.inline_entries
+                                                     : &_overflow[header.offset];
+      std::memcpy(&_overflow[offset], from, header.size * sizeof(uint32_t));
+
+      header.offset = offset;
+      header.capacity = capacity;
+    }
+
+    _overflow[header.offset + header.size++] = entry;
+  }
+
+  // the last entry of the list of key, which must not be empty
+  inline uint32_t back(size_t key) const { return (*this)[key].last[-1]; }
+
+  // entries the overflow region can hold
+  static const size_t OVERFLOW_LIMIT = UINT32_MAX;
+
+  // returns the bytes allocated for the headers and the overflow region
+  inline size_t bytes() const {
+    return (_num_keys + 1) * sizeof(_Header) + _overflow.capacity() * sizeof(uint32_t);
+  }
+
+  inline Range operator[](size_t key) const {
+    const _Header &header = _headers[key];
+    const uint32_t *first = (header.size <= INLINE) ? header.inline_entries
+                                                    : &_overflow[header.offset];
+
+    return {first, first + header.size};
+  }
+
+ private:
+  // entries stored in the header, filling its cache line
+  static const uint32_t INLINE = 13;
+
+  struct _Header {
+    uint32_t size;
+    // position and size of the overflow region once the list spilled
+    uint32_t offset;
+    uint32_t capacity;
+    uint32_t inline_entries[INLINE];
+  };
+
+  static_assert(sizeof(_Header) == 64, "a header must fill one cache line");
+
+  size_t _num_keys = 0;
+  std::unique_ptr<char[]> _raw;
+  _Header *_headers = nullptr;
+  std::vector<uint32_t> _overflow;
+};
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef CCSAT_PHASE_H
+#define CCSAT_PHASE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Memory.h"
+
+namespace ccsat {
+
+// phase policies of the clause-learning engine: the value a decision variable is
+// assigned first. values are 1 (true), -1 (false) or 0 (none).
+
+// plain phase saving: a variable is assigned the value it last had, false initially
+class SavedPhases {
+ public:
+  inline void init(size_t num_vars) { _saved.assign(num_vars, -1); }
+
+  inline size_t bytes() const { return bytesOf(_saved); }
+
+  inline void unassigned(uint32_t var, int8_t value) { _saved[var] = value; }
+
+  inline int8_t phase(uint32_t var, bool) const { return _saved[var]; }
+
+  inline void onConflict(const std::vector<uint32_t> &, const std::vector<int8_t> &, size_t) {}
+  inline void onRestart() {}
+
+  inline bool shouldRephase(uint64_t) const { return false; }
+
+  template <class Walk>
+  inline void rephase(uint64_t, Walk) {}
+
+ private:
+  std::vector<int8_t> _saved;
+};
+
+// phase saving with target and best phases: the longest conflict-free trail since
+// the last restart is followed in stable mode, and the saved phases are periodically
+// reset following the schedule original, best, inverted, best, walk, best.
+class TargetPhases {
+ public:
+  inline void init(size_t num_vars) {
+    _saved.assign(num_vars, -1);
+    _target.assign(num_vars, 0);
+    _best.assign(num_vars, 0);
+    _target_assigned = 0;
+    _best_assigned = 0;
+    _rephases = 0;
+    _next_rephase = REPHASE_INTERVAL;
+  }
+
+  inline size_t bytes() const { return bytesOf(_saved) + bytesOf(_target) + bytesOf(_best); }
+
+  inline void unassigned(uint32_t var, int8_t value) { _saved[var] = value; }
+
+  inline int8_t phase(uint32_t var, bool stable) const {
+    return (stable && _target[var] != 0) ? _target[var] : _saved[var];
+  }
+
+  // records the first assigned literals of the trail as target (and best) phases if
+  // they form the longest conflict-free trail so far
+  inline void onConflict(const std::vector<uint32_t> &trail, const std::vector<int8_t> &vals,
+      size_t assigned) {
+    if (assigned <= _target_assigned)
+      return;
+
+    for (size_t i = 0; i < assigned; ++i)
+      _target[trail[i] >> 1] = vals[trail[i] >> 1];
+    _target_assigned = assigned;
+
+    if (assigned > _best_assigned) {
+      for (size_t i = 0; i < assigned; ++i)
+        _best[trail[i] >> 1] = vals[trail[i] >> 1];
+      _best_assigned = assigned;
+    }
+  }
+
+  inline void onRestart() { _target_assigned = 0; }
+
+  inline bool shouldRephase(uint64_t conflicts) const { return conflicts >= _next_rephase; }
+
+  // overwrites the saved phases according to the next step of the schedule. walk is
+  // called with the saved phases to improve them by local search.
+  // nb: must be called at decision level 0
+  template <class Walk>
+  inline void rephase(uint64_t conflicts, Walk walk) {
+    switch (_schedule(_rephases)) {
+      case ORIGINAL:
+        std::fill(_saved.begin(), _saved.end(), -1);
+        break;
+      case INVERTED:
+        std::fill(_saved.begin(), _saved.end(), 1);
+        break;
+      case BEST:
+        for (size_t var = 0; var < _saved.size(); ++var)
+          if (_best[var] != 0)
+            _saved[var] = _best[var];
+        break;
+      case WALK:
+        walk(_saved);
+        break;
+    }
+
+    // the new phases are the targets from now on
+    _target = _saved;
+    _target_assigned = 0;
+    _best_assigned = 0;
+
+    ++_rephases;
+    _next_rephase = conflicts + (_rephases + 1) * REPHASE_INTERVAL;
+  }
+
+ private:
+  enum _Rephase { ORIGINAL, INVERTED, BEST, WALK };
+
+  // conflicts between rephases grow arithmetically by this amount
+  static constexpr uint64_t REPHASE_INTERVAL = 1000;
+
+  // the rephasing schedule, best phases are restored between the other kinds
+  static inline _Rephase _schedule(uint64_t i) {
+    static const _Rephase schedule[] = {ORIGINAL, BEST, INVERTED, BEST, WALK, BEST};
+
+    return schedule[i % 6];
+  }
+
+  // var -> value it was last assigned, the default decision phase
+  std::vector<int8_t> _saved;
+  // var -> value on the longest conflict-free trail since the last restart, or 0
+  std::vector<int8_t> _target;
+  // var -> value on the longest conflict-free trail since the last rephase, or 0
+  std::vector<int8_t> _best;
+  size_t _target_assigned;
+  size_t _best_assigned;
+
+  uint64_t _rephases;
+  uint64_t _next_rephase;
+};
+
+}
+
+#endif
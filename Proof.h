@@ -0,0 +1,55 @@
+#ifndef CCSAT_PROOF_H
+#define CCSAT_PROOF_H
+
+#include <cstdint>
+#include <ostream>
+
+#include "SAT.h"
+
+namespace ccsat {
+
+// proof tracers of the clause-learning engine, told about every clause the engine
+// derives or deletes. literals are encoded by CNF::encode, the proof is written with the variable numbers of the input (see CNF::names).
+
+// traces nothing
+class NoTracer {
+ public:
+  inline void init(const CNF *) {}
+  inline void add(const uint32_t *, size_t) {}
+  inline void remove(const uint32_t *, size_t) {}
+};
+
+// writes a DRAT proof in the textual format, with the variables of the input, so that
+// unsat answers can be checked (e.g. with drat-trim)
+class DratTracer {
+ public:
+  // nb: out must outlive the tracer
+  explicit DratTracer(std::ostream *out) : _out(out) {}
+
+  // nb: cnf must outlive the solve call
+  inline void init(const CNF *cnf) {
+    _cnf = cnf;
+  }
+
+  inline void add(const uint32_t *lits, size_t size) { _write(lits, size); }
+
+  inline void remove(const uint32_t *lits, size_t size) {
+    *_out << "d ";
+    _write(lits, size);
+  }
+
+ private:
+  inline void _write(const uint32_t *lits, size_t size) {
+    for (size_t i = 0; i < size; ++i)
+      *_out << ((lits[i] & 1) ? "-" : "") << _cnf->name((lits[i] >> 1) + 1) << ' ';
+
+    *_out << "0\n";
+  }
+
+  std::ostream *_out;
+  const CNF *_cnf = nullptr;
+};
+
+}
+
+#endif
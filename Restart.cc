@@ -0,0 +1,44 @@
+#include "Restart.h"
+
+namespace ccsat {
+
+// glucose restart EMA smoothing factors
+static const double FAST_ALPHA = 0.03;
+static const double SLOW_ALPHA = 1e-5;
+static const double TRAIL_ALPHA = 1.0 / 5000;
+
+// unit of the luby sequence in stable mode
+static const uint64_t RELUCTANT_UNIT = 1024;
+// conflicts spent in the first focused mode
+static const uint64_t MODE_LENGTH = 1000;
+
+LubyRestart::LubyRestart(uint64_t unit)
+    : _unit(unit), _index(1), _conflicts(0), _limit(unit) {}
+
+uint64_t LubyRestart::luby(uint64_t i) {
+  // find the finite subsequence containing i, and its size
+  uint64_t x = i - 1;
+  uint64_t size = 1;
+  uint64_t seq = 0;
+  while (size < x + 1) {
+    ++seq;
+    size = 2 * size + 1;
+  }
+
+  while (size - 1 != x) {
+    size = (size - 1) >> 1;
+    --seq;
+    x = x % size;
+  }
+
+  return uint64_t(1) << seq;
+}
+
+GlucoseRestart::GlucoseRestart()
+    : _fast(FAST_ALPHA), _slow(SLOW_ALPHA), _trail(TRAIL_ALPHA), _conflicts(0), _since(0) {}
+
+ModeSwitchRestart::ModeSwitchRestart()
+    : _reluctant(RELUCTANT_UNIT), _stable(false), _conflicts(0),
+      _limit(MODE_LENGTH), _length(MODE_LENGTH) {}
+
+}
@@ -0,0 +1,155 @@
+#ifndef CCSAT_RESTART_H
+#define CCSAT_RESTART_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ccsat {
+
+// exponential moving average with bias correction, so that early values are not
+// dragged towards the zero it starts from
+struct EMA {
+  double value = 0;
+  double biased = 0;
+  double alpha;
+  double exp = 1;
+
+  explicit EMA(double a) : alpha(a) {}
+
+  inline void update(double x) {
+    biased += alpha * (x - biased);
+    exp *= 1 - alpha;
+    value = biased / (1 - exp);
+  }
+};
+
+// restart policies of the clause-learning engine, deciding when it abandons its current
+// trail and restarts from decision level 0 (keeping learned clauses and heuristic
+// scores). a policy provides:
+//   - onConflict(lbd, trail), called after every conflict with the LBD of the learned
+//     clause and the size of the trail at the time of the conflict
+//   - shouldRestart(), true if the engine should restart before its next decision
+//   - onRestart(), called once the engine has restarted
+//   - stable(), true while the search is in stable mode (few restarts), in which the
+//     engine follows target phases rather than saved phases
+
+// restarts after unit * luby(i) conflicts, where luby is the sequence 1 1 2 1 1 2 4 ...
+class LubyRestart {
+ public:
+  explicit LubyRestart(uint64_t unit = 100);
+
+  inline void onConflict(uint32_t, size_t) { ++_conflicts; }
+
+  inline bool shouldRestart() const { return _conflicts >= _limit; }
+
+  inline void onRestart() {
+    _conflicts = 0;
+    _limit = _unit * luby(++_index);
+  }
+
+  inline bool stable() const { return true; }
+
+  // returns the i-th element (starting from 1) of the luby sequence
+  static uint64_t luby(uint64_t i);
+
+ private:
+  uint64_t _unit;
+  uint64_t _index;
+  uint64_t _conflicts;
+  uint64_t _limit;
+};
+
+// glucose-style restarts: restart as soon as the recent (fast) LBD average exceeds the
+// long-term (slow) one by a margin. restarts are blocked when the trail is much longer
+// than usual, as the solver is then likely approaching a satisfying assignment.
+class GlucoseRestart {
+ public:
+  GlucoseRestart();
+
+  inline void onConflict(uint32_t lbd, size_t trail) {
+    ++_conflicts;
+    ++_since;
+
+    _fast.update(lbd);
+    _slow.update(lbd);
+
+    // block the restart if the current trail is much larger than usual
+    if (_conflicts >= BLOCK_MIN_CONFLICTS && trail > BLOCK_MARGIN * _trail.value)
+      _since = 0;
+
+    _trail.update(static_cast<double>(trail));
+  }
+
+  inline bool shouldRestart() const {
+    return _since >= RESTART_MIN_CONFLICTS && _fast.value > RESTART_MARGIN * _slow.value;
+  }
+
+  inline void onRestart() { _since = 0; }
+
+  inline bool stable() const { return false; }
+
+ private:
+  // the margin by which the fast average must exceed the slow one, and the trail ratio
+  // that blocks a restart
+  static constexpr double RESTART_MARGIN = 1.1;
+  static constexpr double BLOCK_MARGIN = 1.4;
+  static const uint64_t BLOCK_MIN_CONFLICTS = 10000;
+  static const uint64_t RESTART_MIN_CONFLICTS = 2;
+
+  EMA _fast;
+  EMA _slow;
+  EMA _trail;
+  uint64_t _conflicts;
+  // conflicts since the last restart (or blocked restart)
+  uint64_t _since;
+};
+
+// alternates between a focused mode using glucose restarts and a stable mode using
+// reluctant doubling (luby restarts with a large unit). every mode lasts twice as many
+// conflicts as the previous one of the same kind.
+class ModeSwitchRestart {
+ public:
+  ModeSwitchRestart();
+
+  inline void onConflict(uint32_t lbd, size_t trail) {
+    ++_conflicts;
+
+    // both policies keep tracking the search, so that switching modes does not start
+    // from stale averages
+    _focused.onConflict(lbd, trail);
+    _reluctant.onConflict(lbd, trail);
+
+    if (_conflicts >= _limit) {
+      _stable = !_stable;
+      if (!_stable)
+        _length *= 2;
+
+      _limit = _conflicts + (_stable ? _length * 2 : _length);
+    }
+  }
+
+  inline bool shouldRestart() const {
+    return _stable ? _reluctant.shouldRestart() : _focused.shouldRestart();
+  }
+
+  inline void onRestart() {
+    if (_stable)
+      _reluctant.onRestart();
+    else
+      _focused.onRestart();
+  }
+
+  inline bool stable() const { return _stable; }
+
+ private:
+  GlucoseRestart _focused;
+  LubyRestart _reluctant;
+  bool _stable;
+  uint64_t _conflicts;
+  uint64_t _limit;
+  uint64_t _length;
+};
+
+}
+
+#endif
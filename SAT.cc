@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <stack>
@@ -10,37 +11,128 @@
 
 namespace ccsat {
 
-bool DPLLSolver::solve(const CNF &cnf) {
+// decisions between two checks of the memory budget
+static const uint64_t MEMORY_CHECK_INTERVAL = 1024;
+
+const char *toString(Result result) {
+  switch (result) {
+    case SAT:
+      return "sat";
+    case UNSAT:
+      return "unsat";
+    default:
+      return "unknown";
+  }
+}
+
+Result Solver::solve(const CNF &cnf) {
+  begin(cnf);
+
+  return resume(0);
+}
+
+void Solver::begin(const CNF &cnf) {
+  _model.clear();
+
   // empty case, trivially sat
-  if (cnf.size() == 0)
-    return true;
+  if (cnf.size() == 0) {
+    _finish(SAT);
+    return;
+  }
 
   // contains an empty clause, unsat
   if (std::any_of(cnf.clauses.begin(), cnf.clauses.end(),
-      [](const auto &clause) { return clause.size() == 0; }))
-    return false;
+      [](const auto &clause) { return clause.size() == 0; })) {
+    _finish(UNSAT);
+    return;
+  }
+
+  _startLimits();
+  _finished = false;
+  _begin(cnf);
+
+  // the clock of the time limit only runs in begin and resume, a scheduler may run
+  // other solves in between
+  _limit_check.pause();
+}
+
+Result Solver::resume(uint64_t ticks) {
+  if (_finished)
+    return _result;
+
+  _limit_check.slice(ticks);
+  Result result = _resume();
+  _limit_check.pause();
+
+  if (result == UNKNOWN && _limit_check.yielded())
+    return UNKNOWN;
+
+  return _finish(result);
+}
+
+void DPLLSolver::_begin(const CNF &cnf) {
+  // give up before allocating if the instance cannot fit the memory budget
+  if (_footprint(cnf) > _maxMemory()) {
+    _finish(UNKNOWN);
+    return;
+  }
 
   _init(cnf);
 
-  return _DPLL();
+  // nb: everything but the search stacks is allocated by now
+  if (_overBudget())
+    _finish(UNKNOWN);
 }
 
-Model DPLLSolver::getModel() const {
-  return _model;
+Result DPLLSolver::_resume() {
+  Result result = _DPLL();
+  if (result == SAT)
+    _model = _renumbering.restore(_model);
+
+  return result;
+}
+
+MemoryUsage DPLLSolver::memoryUsage() const {
+  MemoryUsage usage;
+  usage.clauses = _instance_bytes + _active.bytes() + _modified.bytes() + _has_first.bytes()
+      + _has_second.bytes() + bytesOf(_watched_first) + bytesOf(_watched_second)
+      + bytesOf(_search_pos);
+  usage.lists = _occs.bytes();
+  usage.vars = bytesOf(_vals) + bytesOf(_vars) + bytesOf(_phases);
+  usage.search = bytesOf(_deltas) + bytesOf(_forced) + bytesOf(_priors)
+      + bytesOf(_assn_stack) + bytesOf(_unit_stack);
+
+  return usage;
+}
+
+size_t DPLLSolver::_footprint(const CNF &cnf) const {
+  // the renumbered copy of the clauses, their occurrences and per-clause state, and per
+  // variable its state and the occurrence list headers (a cache line) of both literals
+  return cnf.numLiterals() * (sizeof(Lit) + sizeof(uint32_t))
+      + cnf.size() * (sizeof(Clause) + 2 * sizeof(Lit *) + sizeof(size_t))
+      + size_t(cnf.maxVar()) * (2 * 64 + 2 * sizeof(int8_t) + sizeof(var_t));
 }
 
 void DPLLSolver::_init(const CNF &cnf) {
-  _instance = cnf;
+  // dense variables in an order that keeps related ones (and their clauses) together
+  _renumbering.build(cnf);
+  _instance = _renumbering.apply(cnf);
 
-  // clear any existing garbage
+  // clear any existing garbage, releasing the memory of the search stacks
   _model.clear();
   _vars.clear();
-  _clause_states.clear();
-  _pos_map.clear();
-  _neg_map.clear();
   _deltas = {};
+  _forced = {};
+  _priors = {};
   _assn_stack = {};
   _unit_stack = {};
+  _conflicts = 0;
+  _decisions = 0;
+  _propagations = 0;
+
+  _instance_bytes = bytesOf(_instance.clauses);
+  for (const auto &clause : _instance.clauses)
+    _instance_bytes += bytesOf(clause.lits);
 
   // build _vars, order by # of occurrences in SAT instance
   std::unordered_map<var_t, uint64_t> var_counts;
@@ -60,67 +152,81 @@ void DPLLSolver::_init(const CNF &cnf) {
   for (const auto &vp : sorted_vars)
     _vars.push_back(vp.first);
 
-  // build _clause_states
-  for (size_t i = 0; i < _instance.clauses.size(); ++i) {
-    std::pair<Lit*, Lit*> watched;
+  var_t max_var = 0;
+  for (var_t var : _vars)
+    max_var = std::max(max_var, var);
+
+  _vals.assign(max_var + 1, 0);
+  _phases.assign(max_var + 1, 0);
+
+  // build the clause states
+  const size_t num_clauses = _instance.clauses.size();
+  _active.assign(num_clauses, true);
+  _modified.assign(num_clauses, false);
+  _has_first.assign(num_clauses, false);
+  _has_second.assign(num_clauses, false);
+  _watched_first.assign(num_clauses, nullptr);
+  _watched_second.assign(num_clauses, nullptr);
+  _search_pos.assign(num_clauses, 0);
+
+  for (size_t i = 0; i < num_clauses; ++i) {
+    Lit *first = _findUnassigned(_instance.clauses[i], nullptr, &_search_pos[i]);
+    Lit *second = _findUnassigned(_instance.clauses[i], first, &_search_pos[i]);
+
+    _setWatched(i, first, second);
+  }
 
-    watched.first = _findUnassigned(_instance.clauses[i], nullptr);
-    watched.second = _findUnassigned(_instance.clauses[i], watched.first);
+  // build _occs, every clause is listed once per literal
+  _occs.init(_occKey(max_var, true) + 1);
 
-    _clause_states.push_back({watched, true, false});
-  }
+  for (size_t i = 0; i < _instance.clauses.size(); ++i) {
+    for (const auto &lit : _instance.clauses[i].lits) {
+      size_t key = _occKey(lit.var, lit.sign);
 
-  // build _pos_map, _neg_map
-  for (var_t var : _vars) {
-    _pos_map.insert(std::make_pair(var, std::vector<size_t>()));
-    _neg_map.insert(std::make_pair(var, std::vector<size_t>()));
-
-    for (size_t i = 0; i < _instance.clauses.size(); ++i) {
-      for (const auto &lit : _instance.clauses[i].lits) {
-        if (lit.var == var) {
-          if (lit.sign && (std::find(_neg_map[var].begin(), _neg_map[var].end(), i)
-              == _neg_map[var].end())) {
-            _neg_map[var].push_back(i);
-          } else if (std::find(_pos_map[var].begin(), _pos_map[var].end(), i)
-              == _pos_map[var].end()) {
-            _pos_map[var].push_back(i);
-          }
-        }
-      }
+      if (_occs[key].empty() || _occs.back(key) != i)
+        _occs.push(key, static_cast<uint32_t>(i));
     }
   }
 
   // push root decisions
   var_t initial_var;
-  _chooseVar(&initial_var);
-
-  _assn_stack.push({initial_var, true});
-  _assn_stack.push({initial_var, false});
+  if (_chooseVar(&initial_var))
+    _pushBranches(initial_var);
 }
 
-bool DPLLSolver::_DPLL() {
+Result DPLLSolver::_DPLL() {
   while (!_assn_stack.empty()) {
+    if (_shouldYield(_conflicts, _decisions, _propagations))
+      return UNKNOWN;
+    if (++_decisions % MEMORY_CHECK_INTERVAL == 0 && _overBudget())
+      return UNKNOWN;
+
     // mark all clauses unmodified (state only used during decision propagation)
-    for (auto &cstate : _clause_states)
-      cstate.modified = false;
+    _modified.reset();
 
     // make a decision, immediately backtrack if it caused contradictions
-    bool consistent = _decide(_assn_stack.top());
-    _assn_stack.pop();
+    bool consistent = _decide(_assn_stack.back());
+    _assn_stack.pop_back();
+
+    // the decision may have been left half propagated
+    if (_limitReached(_conflicts, _decisions, _propagations))
+      return UNKNOWN;
 
     if (!consistent) {
+      ++_conflicts;
       if (!_backtrack())
-        return false;
+        return UNSAT;
 
       continue;
     }
 
     if (_complete()) {
+      _buildModel();
       if (_instance.eval(_model))
-        return true;
+        return SAT;
 
       if (!_backtrack())
-        return false;
+        return UNSAT;
 
       continue;
     }
@@ -129,7 +235,7 @@ bool DPLLSolver::_DPLL() {
     if (_allInactive()) {
       _completeModel();
 
-      return true;
+      return SAT;
     }
 
     // choose a variable and push its possible assignments
@@ -137,34 +243,44 @@ bool DPLLSolver::_DPLL() {
     var_t var;
     if (!_chooseVar(&var)) {
       // this should never happen
-      return false;
+      return UNSAT;
     }
 
-    _assn_stack.push({var, true});
-    _assn_stack.push({var, false});
+    _pushBranches(var);
   }
 
-  return false;
+  return UNSAT;
 }
 
 bool DPLLSolver::_undo() {
   if (_deltas.empty()) return false;
 
-  _SolverDelta delta = _deltas.top();
-  _deltas.pop();
+  const _SolverDelta &delta = _deltas.back();
 
-  // undo assignments
-  _model.erase(delta.principal.var);
+  // undo assignments, remembering their phases
+  _phases[delta.principal.var] = _vals[delta.principal.var];
+  _vals[delta.principal.var] = 0;
 
-  for (const auto &lit : delta.forced) {
-    _model.erase(lit.var);
+  for (size_t i = delta.forced_start; i < _forced.size(); ++i) {
+    _phases[_forced[i].var] = _vals[_forced[i].var];
+    _vals[_forced[i].var] = 0;
   }
 
   // restore clause states
-  for (const auto &cspair : delta.priors) {
-    _clause_states[cspair.first] = cspair.second;
+  for (size_t i = delta.priors_start; i < _priors.size(); ++i) {
+    const auto &cspair = _priors[i];
+    const _ClauseState &cstate = cspair.second;
+
+    _active.set(cspair.first, cstate.active);
+    _modified.set(cspair.first, false);
+    _setWatched(cspair.first, cstate.watched.first, cstate.watched.second);
+    _search_pos[cspair.first] = cstate.search_pos;
   }
 
+  _forced.resize(delta.forced_start);
+  _priors.resize(delta.priors_start);
+  _deltas.pop_back();
+
   return true;
 }
 
@@ -172,7 +288,7 @@ bool DPLLSolver::_backtrack() {
   if (_deltas.empty() || _assn_stack.empty()) return false;
 
   // undo until we reach the matching delta
-  while (!(_deltas.top().principal == _assn_stack.top().negate())) {
+  while (!(_deltas.back().principal == _assn_stack.back().negate())) {
     if (!_undo()) return false;
   }
 
@@ -186,79 +302,77 @@ bool DPLLSolver::_backtrack() {
 }
 
 bool DPLLSolver::_decide(const Lit &lit) {
-  _deltas.emplace();
-  _SolverDelta &delta = _deltas.top();
-
-  delta.principal = lit;
-  _model[lit.var] = !lit.sign;
+  _deltas.push_back({lit, _forced.size(), _priors.size()});
+  _assign(lit);
 
-  if(!_unitPropagate(lit, &delta)) return false;
+  if(!_unitPropagate(lit)) return false;
 
+  // nb: the scans for units and pure literals stop early once a limit is reached, the
+  //     search is abandoned then
   Lit unit;
-  while (_findUnit(&unit)) {
-    delta.forced.push_back(unit);
-    _model[unit.var] = !unit.sign;
-    if(!_unitPropagate(unit, &delta)) return false;
+  while (!_limitReached(_conflicts, _decisions, _propagations) && _findUnit(&unit)) {
+    _forced.push_back(unit);
+    _assign(unit);
+    if(!_unitPropagate(unit)) return false;
   }
 
   Lit pure;
-  while (_findPure(&pure)) {
-    delta.forced.push_back(pure);
-    _model[pure.var] = !pure.sign;
-    _pureAssign(pure, &delta);
+  while (!_limitReached(_conflicts, _decisions, _propagations) && _findPure(&pure)) {
+    _forced.push_back(pure);
+    _assign(pure);
+    _pureAssign(pure);
   }
 
   return true;
 }
 
-bool DPLLSolver::_unitPropagate(const Lit &lit, _SolverDelta *delta) {
+bool DPLLSolver::_unitPropagate(const Lit &lit) {
   // indices of clauses that contain lit and ~lit
-  const std::vector<size_t> &pos_indices =
-      lit.sign ? _neg_map[lit.var] : _pos_map[lit.var];
-  const std::vector<size_t> &neg_indices =
-      lit.sign ? _pos_map[lit.var] : _neg_map[lit.var];
+  OccLists::Range pos_indices = _occs[_occKey(lit.var, lit.sign)];
+  OccLists::Range neg_indices = _occs[_occKey(lit.var, !lit.sign)];
 
   for (auto i : pos_indices) {
-    if (_clause_states[i].active) {
-      _storeClause(std::make_pair(i, _clause_states[i]), delta);
+    if (_active.test(i)) {
+      _storeClause(i);
 
       // mark inactive, satisfied under the model now
-      _clause_states[i].active = false;
+      _active.set(i, false);
     }
   }
 
   Lit negated = lit.negate();
   for (auto i : neg_indices) {
-    _ClauseState &cstate = _clause_states[i];
-    if (cstate.active) {
-      _storeClause(std::make_pair(i, cstate), delta);
+    if (_active.test(i)) {
+      _storeClause(i);
 
       // update the watchlist
-      if (cstate.watched.first != nullptr && *cstate.watched.first == negated) {
+      Lit *first = _watched_first[i];
+      Lit *second = _watched_second[i];
+      if (first != nullptr && *first == negated) {
         // find a unique unassigned literal to watch (might not exist)
-        cstate.watched.first = _findUnassigned(_instance.clauses[i], cstate.watched.second);
-      } else if (cstate.watched.second != nullptr && *cstate.watched.second == negated) {
-        cstate.watched.second = _findUnassigned(_instance.clauses[i], cstate.watched.first);
+        first = _findUnassigned(_instance.clauses[i], second, &_search_pos[i]);
+      } else if (second != nullptr && *second == negated) {
+        second = _findUnassigned(_instance.clauses[i], first, &_search_pos[i]);
       }
+      _setWatched(i, first, second);
 
-      if (cstate.empty()) return false;
-      if (cstate.unital()) _unit_stack.push_back(*cstate.getUnit());
+      if (first == nullptr && second == nullptr) return false;
+      if (_unital(i)) _unit_stack.push_back(*_getUnit(i));
     }
   }
 
   return true;
 }
 
-void DPLLSolver::_pureAssign(const Lit &pure, _SolverDelta *delta) {
+void DPLLSolver::_pureAssign(const Lit &pure) {
   // pure is guaranteed to be pure in the current active clauses
-  const std::vector<size_t> &indices =
-    pure.sign ? _neg_map[pure.var] : _pos_map[pure.var];
+  OccLists::Range indices = _occs[_occKey(pure.var, pure.sign)];
 
   for (auto i : indices) {
-    if (_clause_states[i].active) {
-      _storeClause(std::make_pair(i, _clause_states[i]), delta);
+    if (_active.test(i)) {
+      _storeClause(i);
 
-      _clause_states[i].active = false;
+      _active.set(i, false);
     }
   }
 }
@@ -271,15 +385,17 @@ bool DPLLSolver::_findUnit(Lit *out) {
     return true;
   }
 
-  for (auto &cstate : _clause_states) {
-    if (cstate.active && cstate.unital()) {
-      *out = *cstate.getUnit();
+  // active clauses watching exactly one literal, 64 clauses at a time
+  size_t i = findFirst(_active.numWords(), [this](size_t w) {
+    return _active.word(w) & (_has_first.word(w) ^ _has_second.word(w));
+  });
 
-      return true;
-    }
-  }
+  if (i == SIZE_MAX)
+    return false;
 
-  return false;
+  *out = *_getUnit(i);
+
+  return true;
 }
 
 // this method is annoying, might have bad runtime
@@ -290,8 +406,8 @@ bool DPLLSolver::_findPure(Lit *out) {
       bool found = false;
       bool pol;
 
-      for (size_t pos_index : _pos_map[var]) {
-        if (_clause_states[pos_index].active) {
+      for (auto pos_index : _occs[_occKey(var, false)]) {
+        if (_active.test(pos_index)) {
           found = true;
           pol = false;
 
@@ -299,8 +415,8 @@ bool DPLLSolver::_findPure(Lit *out) {
         }
       }
 
-      for (size_t neg_index : _neg_map[var]) {
-        if (_clause_states[neg_index].active) {
+      for (auto neg_index : _occs[_occKey(var, true)]) {
+        if (_active.test(neg_index)) {
           if (found) {
             // bad, not pure
             found = false;
@@ -329,17 +445,25 @@ bool DPLLSolver::_findPure(Lit *out) {
 // this checks out, since watched literals are only updated when forced
 // falsities occur.
 bool DPLLSolver::_hasEmpty() const {
-  for (const auto &cs : _clause_states)
-    if (cs.active && cs.empty())
-      return true;
-
-  return false;
+  return findFirst(_active.numWords(), [this](size_t w) {
+    return _active.word(w) & ~(_has_first.word(w) | _has_second.word(w));
+  }) != SIZE_MAX;
 }
 
 void DPLLSolver::_completeModel() {
   for (var_t var : _vars)
     if (!_isAssigned(var))
-      _model[var] = false;
+      _vals[var] = -1;
+
+  _buildModel();
+}
+
+void DPLLSolver::_buildModel() {
+  _model.clear();
+
+  for (var_t var : _vars)
+    if (_isAssigned(var))
+      _model[var] = (_vals[var] == 1);
 }
 
 bool DPLLSolver::_complete() const {
@@ -351,22 +475,20 @@ bool DPLLSolver::_complete() const {
 }
 
 bool DPLLSolver::_allInactive() const {
-  for (const auto &cstate : _clause_states)
-    if (cstate.active)
-      return false;
-
-  return true;
+  return !_active.any();
 }
 
-bool DPLLSolver::_isAssigned(var_t var) const {
-  return _model.count(var) == 1;
-}
+Lit *DPLLSolver::_findUnassigned(Clause &clause, const Lit *banned, size_t *pos) const {
+  const size_t size = clause.lits.size();
+
+  for (size_t n = 0, i = *pos; n < size; ++n, i = (i + 1 == size) ? 0 : i + 1) {
+    Lit &lit = clause.lits[i];
 
-Lit *DPLLSolver::_findUnassigned(Clause &clause, const Lit *banned) const {
-  for (auto &lit : clause.lits) {
     if (!_isAssigned(lit.var)) {
-      if (banned == nullptr || !(lit == *banned))
+      if (banned == nullptr || !(lit == *banned)) {
+        *pos = i;
         return &lit;
+      }
     }
   }
 
@@ -384,40 +506,266 @@ bool DPLLSolver::_chooseVar(var_t *out) const {
   return false;
 }
 
-void DPLLSolver::_storeClause(const std::pair<size_t, _ClauseState> &cspair, _SolverDelta *delta) {
+void DPLLSolver::_pushBranches(var_t var) {
+  // the top of the stack is tried first, positive unless var was last false
+  bool phase = _phases[var] >= 0;
+
+  _assn_stack.push_back({var, phase});
+  _assn_stack.push_back({var, !phase});
+}
+
+void DPLLSolver::_storeClause(size_t i) {
   // we don't want to have multiple prior states, only the oldest one, since the 'newer'
   // states are actually forced from the initial assignment
-  if (!_clause_states[cspair.first].modified) {
-    delta->priors.push_back(cspair);
+  if (!_modified.test(i)) {
+    _ClauseState cstate = {{_watched_first[i], _watched_second[i]}, _active.test(i), _search_pos[i]};
+    _priors.push_back(std::make_pair(i, cstate));
+
+    _modified.set(i, true);
+  }
+}
+
+bool CNF::normalize(const Clause &clause, std::vector<uint32_t> &lits) {
+  lits.clear();
+  for (const auto &lit : clause.lits)
+    lits.push_back(encode(lit));
+
+  std::sort(lits.begin(), lits.end());
+  lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+
+  for (size_t i = 1; i < lits.size(); ++i)
+    if ((lits[i] ^ 1) == lits[i - 1])
+      return false;
 
-    _clause_states[cspair.first].modified = true;
+  return true;
+}
+
+void Renumbering::build(const CNF &cnf) {
+  _to_internal.clear();
+  _to_external.assign(1, 0);
+
+  // compact the variables to 0 .. n - 1 first, in order of appearance
+  std::unordered_map<var_t, uint32_t> dense;
+  std::vector<var_t> vars;
+  for (const auto &clause : cnf.clauses)
+    for (const auto &lit : clause.lits)
+      if (dense.insert(std::make_pair(lit.var, static_cast<uint32_t>(vars.size()))).second)
+        vars.push_back(lit.var);
+
+  const size_t num_vars = vars.size();
+
+  // var -> clauses containing it, and var -> number of occurrences as its degree
+  std::vector<uint32_t> start(num_vars + 1, 0);
+  for (const auto &clause : cnf.clauses)
+    for (const auto &lit : clause.lits)
+      ++start[dense[lit.var] + 1];
+
+  for (size_t v = 0; v < num_vars; ++v)
+    start[v + 1] += start[v];
+
+  std::vector<uint32_t> occs(start[num_vars]);
+  std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+  for (size_t i = 0; i < cnf.clauses.size(); ++i)
+    for (const auto &lit : cnf.clauses[i].lits)
+      occs[fill[dense[lit.var]]++] = static_cast<uint32_t>(i);
+
+  auto degree = [&start](uint32_t v) { return start[v + 1] - start[v]; };
+
+  // components are started from their lowest degree variable
+  std::vector<uint32_t> by_degree(num_vars);
+  for (uint32_t v = 0; v < num_vars; ++v)
+    by_degree[v] = v;
+  std::stable_sort(by_degree.begin(), by_degree.end(),
+      [&degree](uint32_t a, uint32_t b) { return degree(a) < degree(b); });
+
+  // breadth-first search, expanding every clause once: the unvisited variables of the
+  // clauses of the current variable are its unvisited neighbors
+  std::vector<uint8_t> visited(num_vars, 0);
+  std::vector<uint8_t> expanded(cnf.clauses.size(), 0);
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> neighbors;
+  order.reserve(num_vars);
+
+  for (auto root : by_degree) {
+    if (visited[root])
+      continue;
+
+    visited[root] = 1;
+    order.push_back(root);
+
+    for (size_t head = order.size() - 1; head < order.size(); ++head) {
+      uint32_t v = order[head];
+
+      neighbors.clear();
+      for (uint32_t k = start[v]; k < start[v + 1]; ++k) {
+        uint32_t c = occs[k];
+        if (expanded[c])
+          continue;
+
+        expanded[c] = 1;
+        for (const auto &lit : cnf.clauses[c].lits) {
+          uint32_t u = dense[lit.var];
+          if (!visited[u]) {
+            visited[u] = 1;
+            neighbors.push_back(u);
+          }
+        }
+      }
+
+      std::stable_sort(neighbors.begin(), neighbors.end(),
+          [&degree](uint32_t a, uint32_t b) { return degree(a) < degree(b); });
+      order.insert(order.end(), neighbors.begin(), neighbors.end());
+    }
+  }
+
+  for (auto v : order) {
+    _to_internal[vars[v]] = static_cast<var_t>(_to_external.size());
+    _to_external.push_back(vars[v]);
+  }
+}
+
+CNF Renumbering::apply(const CNF &cnf) const {
+  CNF renumbered;
+  renumbered.clauses.reserve(cnf.clauses.size());
+
+  for (const auto &clause : cnf.clauses) {
+    Clause copy;
+    copy.lits.reserve(clause.size());
+
+    for (const auto &lit : clause.lits)
+      copy.lits.push_back({_to_internal.at(lit.var), lit.sign});
+
+    renumbered.clauses.push_back(std::move(copy));
   }
+
+  // the minimum variable of a clause, empty clauses first
+  auto min_var = [](const Clause &clause) {
+    var_t min = 0;
+    for (const auto &lit : clause.lits)
+      if (min == 0 || lit.var < min)
+        min = lit.var;
+
+    return min;
+  };
+
+  std::stable_sort(renumbered.clauses.begin(), renumbered.clauses.end(),
+      [&min_var](const Clause &a, const Clause &b) { return min_var(a) < min_var(b); });
+
+  return renumbered;
+}
+
+Model Renumbering::restore(const Model &model) const {
+  Model restored;
+
+  for (const auto &assignment : model)
+    restored[_to_external[assignment.first]] = assignment.second;
+
+  return restored;
+}
+
+// appends the DIMACS literal val of cnf to clause, renumbering its variable densely
+// through vars (input number -> dense var)
+static void addLiteral(CNF &cnf, std::unordered_map<uint64_t, var_t> &vars, Clause &clause,
+    long long val) {
+  bool sign = val < 0;
+  uint64_t name = sign ? -static_cast<uint64_t>(val) : static_cast<uint64_t>(val);
+
+  auto it = vars.insert(std::make_pair(name, static_cast<var_t>(cnf.names.size() + 1))).first;
+  if (it->second > cnf.names.size())
+    cnf.names.push_back(name);
+
+  clause.lits.push_back({it->second, sign});
+}
+
+// parses the DIMACS literal token into lit, returns false unless it is an integer whose
+// absolute value fits in 63 bits
+static bool parseLiteral(const std::string &token, int64_t *lit) {
+  const bool negative = !token.empty() && token[0] == '-';
+  const size_t start = negative ? 1 : 0;
+  if (start == token.size())
+    return false;
+
+  uint64_t value = 0;
+  for (size_t i = start; i < token.size(); ++i) {
+    if (token[i] < '0' || token[i] > '9')
+      return false;
+
+    const uint64_t digit = token[i] - '0';
+    if (value > (INT64_MAX - digit) / 10)
+      return false;
+    value = 10 * value + digit;
+  }
+
+  *lit = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+  return true;
 }
 
 CNF CNF::fromDIMACS(std::istream &os) {
   ccsat::CNF cnf;
 
+  // input number -> dense var
+  std::unordered_map<uint64_t, var_t> vars;
+
+  // clauses are read from the stream of literals and end at a 0, so a line may hold
+  // several clauses and a clause may span several lines
+  ccsat::Clause clause;
   std::string line;
-  while (std::getline(os, line)) {
-    if (line[0] == '%')
+  for (size_t line_number = 1; std::getline(os, line); ++line_number) {
+    if (!line.empty() && line[0] == '%')
       break;
 
-    if (line.empty() || line[0] == 'c' || line[0] == 'p')
+    if (!line.empty() && (line[0] == 'c' || line[0] == 'p'))
       continue;
 
-    std::stringstream ss(line);
-    int val;
-    ccsat::Clause clause;
-    while (ss >> val) {
-      if (val == 0)
-        break;
+    std::istringstream ss(line);
+    std::string token;
+    while (ss >> token) {
+      int64_t val;
+      if (!parseLiteral(token, &val)) {
+        throw std::runtime_error("line " + std::to_string(line_number)
+            + ": bad literal " + token);
+      }
+
+      if (val != 0) {
+        addLiteral(cnf, vars, clause, val);
+        continue;
+      }
+
+      cnf.clauses.push_back(std::move(clause));
+      clause = ccsat::Clause();
+    }
+  }
+
+  // the last clause may omit its terminator
+  if (!clause.lits.empty())
+    cnf.clauses.push_back(std::move(clause));
+
+  return cnf;
+}
+
+CNF CNF::fromBinary(const int64_t *lits, size_t count) {
+  ccsat::CNF cnf;
+
+  std::unordered_map<uint64_t, var_t> vars;
 
-      bool sign = val < 0;
-      clause.lits.push_back({static_cast<uint32_t>(std::abs(val)), sign});
+  ccsat::Clause clause;
+  for (size_t i = 0; i < count; ++i) {
+    if (lits[i] == INT64_MIN)
+      throw std::runtime_error("bad literal " + std::to_string(lits[i]));
+
+    if (lits[i] != 0) {
+      addLiteral(cnf, vars, clause, lits[i]);
+      continue;
     }
-    cnf.clauses.push_back(clause);
+
+    cnf.clauses.push_back(std::move(clause));
+    clause = ccsat::Clause();
   }
 
+  // the last clause may omit its terminator
+  if (!clause.lits.empty())
+    cnf.clauses.push_back(std::move(clause));
+
   return cnf;
 }
 
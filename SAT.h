@@ -12,6 +12,11 @@
 #include <deque>
 #include <list>
 
+#include "BitVector.h"
+#include "Limits.h"
+#include "Memory.h"
+#include "OccLists.h"
+
 namespace ccsat {
 
 typedef uint32_t var_t;
@@ -54,10 +59,58 @@ struct Clause {
 struct CNF {
   std::vector<Clause> clauses;
 
+  // var - 1 -> number of var in the input the instance was loaded from, if the loader
+  // renumbered the variables. empty if the variables are the input numbers.
+  std::vector<uint64_t> names;
+
+  // reads a DIMACS instance. clauses end at a 0 wherever it is, so a line may hold several
+  // clauses and a clause may span lines. the variables are renumbered densely (1, 2, ...
+  // in order of appearance), so input numbers may be sparse and up to 63 bits, see names.
+  // throws std::runtime_error naming the line of a token that is not such a literal.
   static CNF fromDIMACS(std::istream &os);
 
+  // reads an instance of count literals in the binary format: DIMACS literals as 64-bit
+  // integers, every clause terminated by 0. variables are renumbered like fromDIMACS.
+  // throws std::runtime_error on INT64_MIN, whose variable does not fit in 63 bits.
+  static CNF fromBinary(const int64_t *lits, size_t count);
+
   inline size_t size() const { return clauses.size(); }
 
+  // returns the number of literals over all clauses
+  inline size_t numLiterals() const {
+    size_t count = 0;
+    for (const auto &clause : clauses)
+      count += clause.size();
+
+    return count;
+  }
+
+  // returns the largest variable, the number of variables if they are dense
+  inline var_t maxVar() const {
+    if (!names.empty())
+      return static_cast<var_t>(names.size());
+
+    var_t max_var = 0;
+    for (const auto &clause : clauses)
+      for (const auto &lit : clause.lits)
+        max_var = std::max(max_var, lit.var);
+
+    return max_var;
+  }
+
+  // returns the number of var in the input
+  inline uint64_t name(var_t var) const { return names.empty() ? var : names[var - 1]; }
+
+  // returns lit encoded as 2 * (var - 1) + sign, for engines that keep per-variable
+  // state in flat arrays over the dense variables 1 .. maxVar()
+  static inline uint32_t encode(const Lit &lit) {
+    return 2 * (lit.var - 1) + (lit.sign ? 1 : 0);
+  }
+
+  // outputs the encoded literals of clause through lits, sorted and without duplicates,
+  // and returns true, or returns false if clause is a tautology
+  static bool normalize(const Clause &clause, std::vector<uint32_t> &lits);
+
   inline bool eval(const Model &m) const {
     for (const auto &clause : clauses)
       if (!clause.eval(m))
@@ -67,62 +120,179 @@ struct CNF {
   }
 };
 
+// renumbering of the variables of a CNF instance to the dense range 1 .. n, in an order
+// that keeps interacting variables close: a Cuthill-McKee pass (a breadth-first search
+// visiting neighbors by increasing degree) over the graph connecting the variables of
+// every clause. the per-variable and per-clause arrays of an engine running on the
+// renumbered instance then have related entries on the same cache lines.
+class Renumbering {
+ public:
+  // computes the order of the variables of cnf
+  void build(const CNF &cnf);
+
+  // returns cnf with its variables renumbered and its clauses sorted by their minimum
+  // variable
+  CNF apply(const CNF &cnf) const;
+
+  // maps a model of the renumbered instance back to the original variables
+  Model restore(const Model &model) const;
+
+ private:
+  // original var -> renumbered var
+  std::unordered_map<var_t, var_t> _to_internal;
+  // renumbered var -> original var, 0 is unused
+  std::vector<var_t> _to_external;
+};
+
+// the answer of a solver. UNKNOWN when it gave up before finding out, on reaching its
+// Limits or running out of its memory budget.
+enum Result { SAT, UNSAT, UNKNOWN };
+
+// returns "sat", "unsat" or "unknown"
+const char *toString(Result result);
+
 class Solver {
  public:
-  // returns true if the given CNF SAT instance is satisfiable, false otherwise
-  virtual bool solve(const CNF &cnf) = 0;
+  // returns SAT if the given CNF SAT instance is satisfiable, UNSAT if not, or UNKNOWN
+  // if the solver gave up
+  Result solve(const CNF &cnf);
+
+  // resumable solving, for running many solves on one thread (see Scheduler.h). begin
+  // prepares a solve of cnf, which must outlive it, and resume runs it until it is
+  // finished or about ticks more propagations are done (0 for no slice). resume
+  // returns the result once finished, and UNKNOWN with finished() false otherwise.
+  // the time limit counts the time spent in begin and resume, not between slices.
+  void begin(const CNF &cnf);
+  Result resume(uint64_t ticks);
+
+  inline bool finished() const { return _finished; }
+
+  // returns the model solving the SAT instance on SAT, otherwise undefined
+  inline Model getModel() const { return _model; }
+
+  // returns the memory currently used by the solver
+  virtual MemoryUsage memoryUsage() const = 0;
+
+  // sets the limits of the solves started from now on
+  inline void setLimits(const Limits &limits) { _limits = limits; }
+
+  // sets a callback called with the statistics of the running solve about every
+  // interval seconds, from the thread running it
+  inline void setProgress(const ProgressCallback &progress, double interval = 1) {
+    _progress = progress;
+    _progress_interval = interval;
+  }
 
-  // returns the model solving the SAT instance on sat, otherwise undefined
-  virtual Model getModel() const = 0;
+  // asks the running solve to stop at its next safe point, it then returns UNKNOWN.
+  // may be called from any thread. the request stands until clearTerminate, which
+  // solveAsync calls before starting a solve.
+  inline void terminate() { _terminate.store(true, std::memory_order_relaxed); }
+  inline void clearTerminate() { _terminate.store(false, std::memory_order_relaxed); }
 
   virtual ~Solver() {}
+
+ protected:
+  // the engine side of begin, for an instance with clauses, none of them empty. prepares
+  // the solve, and finishes it if the outcome is already known (or the instance cannot
+  // fit the memory budget).
+  virtual void _begin(const CNF &cnf) = 0;
+
+  // the engine side of resume: searches until the outcome is known or _shouldYield, and
+  // fills _model on SAT
+  virtual Result _resume() = 0;
+
+  // starts checking the limits and the termination flag of a solve with _limit_check
+  inline void _startLimits() {
+    _limit_check.start(_limits, &_terminate, _progress, _progress_interval);
+  }
+
+  // returns true once a limit of the solve is reached, given the engine's counters
+  inline bool _limitReached(uint64_t conflicts, uint64_t decisions, uint64_t propagations) {
+    return _limit_check.reached(conflicts, decisions, propagations);
+  }
+
+  // returns true if a limit is reached or the slice is over, given the engine's
+  // counters. checked where the search can be resumed from.
+  inline bool _shouldYield(uint64_t conflicts, uint64_t decisions, uint64_t propagations) {
+    return _limit_check.yield(conflicts, decisions, propagations);
+  }
+
+  // returns the memory budget of the solve in bytes, SIZE_MAX if it has none
+  inline size_t _maxMemory() const {
+    const size_t budget = _limit_check.limits().memory;
+    return budget == 0 ? SIZE_MAX : budget;
+  }
+
+  // returns the estimated footprint in bytes above which the solve runs lean
+  inline size_t _leanThreshold() const {
+    const size_t threshold = _limit_check.limits().lean;
+    return threshold == 0 ? physicalMemory() / 2 : threshold;
+  }
+
+  // returns true if a memory budget is set and the solver uses more than it
+  inline bool _overBudget() const {
+    return _maxMemory() != SIZE_MAX && memoryUsage().total() > _maxMemory();
+  }
+
+  // ends the solve with result, and returns it
+  inline Result _finish(Result result) {
+    _finished = true;
+    _result = result;
+    return result;
+  }
+
+  Limits _limits;
+  ProgressCallback _progress;
+  double _progress_interval = 1;
+  std::atomic<bool> _terminate{false};
+  LimitCheck _limit_check;
+
+  // whether the solve is over, and its result if so
+  bool _finished = true;
+  Result _result = UNKNOWN;
+
+  // the model of the last solve, on SAT
+  Model _model;
 };
 
 class DPLLSolver : public Solver {
  public:
-  bool solve(const CNF &cnf) override;
-  Model getModel() const override;
+  MemoryUsage memoryUsage() const override;
+
+ protected:
+  void _begin(const CNF &cnf) override;
+  Result _resume() override;
 
  private:
+  // the state of a clause as saved in a delta, see the per-clause arrays below
   struct _ClauseState {
     std::pair<Lit*, Lit*> watched;
-    // true if this clause is not sat under the current model, else false
     bool active;
-
-    // keeps track of whether or not the state has been modified
-    //  - false immediately after backtracking and before a decision
-    //  - true if this state was modified during a decision, false otherwise
-    bool modified;
-
-    inline bool empty() const {
-      return (watched.first == nullptr) && (watched.second == nullptr);
-    }
-
-    inline bool unital() const {
-      return (watched.first != nullptr) ^ (watched.second != nullptr);
-    }
-
-    inline Lit* getUnit() {
-      return watched.first != nullptr ? watched.first : watched.second;
-    }
+    size_t search_pos;
   };
 
-  // represents the solver state change occuring after a nondeterministic assignment
+  // represents the solver state change occuring after a nondeterministic assignment.
+  // the forced assignments and prior clause states of all deltas are kept in two
+  // stacks, _forced and _priors, those of a delta starting where it says.
   struct _SolverDelta {
-    // the forced assignments associated with this delta
-    std::list<Lit> forced;
     // the principal (nondeterministic) assignment associated with this delta
     Lit principal;
 
-    // PRIOR _ClauseStates that were affected (due to principal & forced assignments)
-    // this is used to restore the previous solver state when backtracking
-    // size_t indexes into _clause_states
-    std::deque<std::pair<size_t, _ClauseState>> priors;
+    // start of the forced assignments associated with this delta in _forced
+    size_t forced_start;
+
+    // start of the PRIOR _ClauseStates that were affected (due to principal & forced
+    // assignments) in _priors. this is used to restore the previous solver state when
+    // backtracking
+    size_t priors_start;
   };
 
   // initializes the solver on the given CNF SAT instance
   void _init(const CNF &cnf);
-  bool _DPLL();
+  Result _DPLL();
+
+  // returns an estimate of the memory the solver takes for cnf, before allocating it
+  size_t _footprint(const CNF &cnf) const;
 
   // when _deltas nonempty:
   //    - pops _deltas and restores state
@@ -134,13 +304,30 @@ class DPLLSolver : public Solver {
   // backtracks appropriately w.r.t. the next assignment and returns true, or false if not possible
   bool _backtrack();
 
-  // safely stores cspair (i.e. does not store if already present, so as to preserve
-  // the oldest state)
-  void _storeClause(const std::pair<size_t, _ClauseState> &cspair, _SolverDelta *delta);
+  // safely stores the state of clause i in the top delta (i.e. does not store if
+  // already present, so as to preserve the oldest state)
+  void _storeClause(size_t i);
+
+  // sets the watched literals of clause i, either may be null
+  inline void _setWatched(size_t i, Lit *first, Lit *second) {
+    _watched_first[i] = first;
+    _watched_second[i] = second;
+    _has_first.set(i, first != nullptr);
+    _has_second.set(i, second != nullptr);
+  }
+
+  // a clause is unit iff exactly one literal is watched, the unit
+  inline bool _unital(size_t i) const { return _has_first.test(i) ^ _has_second.test(i); }
+  inline Lit *_getUnit(size_t i) const {
+    return _has_first.test(i) ? _watched_first[i] : _watched_second[i];
+  }
 
   // returns true and outputs an unassigned variable throught out if exists, false otherwise
   bool _chooseVar(var_t *out) const;
 
+  // pushes both assignments of var, such that its saved phase is tried first
+  void _pushBranches(var_t var);
+
   // decides lit to be true and updates the model, deltas, and clause states accordingly
   // nb: this represents a NONDETERMINISTIC assignment, i.e. not forced by previous assignments,
   //     hence it has an associated delta. Forced assignments are directly tied to the delta of
@@ -149,19 +336,30 @@ class DPLLSolver : public Solver {
   bool _decide(const Lit &lit);
 
   // returns true if var is assigned in the model, false otherwise
-  bool _isAssigned(var_t var) const;
+  inline bool _isAssigned(var_t var) const { return _vals[var] != 0; }
+
+  // assigns lit to be true
+  inline void _assign(const Lit &lit) {
+    _vals[lit.var] = lit.sign ? -1 : 1;
+    ++_propagations;
+  }
 
-  // finds an unassigned Lit in clause not equal to banned if banned is non-null, else no restriction
-  Lit *_findUnassigned(Clause &clause, const Lit *banned) const;
+  // copies the current assignment into _model
+  void _buildModel();
 
-  // propagates lit (might make additional assignments), updates delta, returns true if no contradictions
+  // finds an unassigned Lit in clause not equal to banned if banned is non-null, else no restriction.
+  // the search starts at *pos and wraps around the end of the clause, *pos is updated to the
+  // position of the found Lit.
+  Lit *_findUnassigned(Clause &clause, const Lit *banned, size_t *pos) const;
+
+  // propagates lit (might make additional assignments), updates the top delta, returns true if no contradictions
   // (i.e. empty clauses) were generated, false otherwise. Additionally, pushes any newly generated unit
   // clauses onto the unit stack.
   // nb: propagation terminates upon encountering any empty clause
-  bool _unitPropagate(const Lit &lit, _SolverDelta *delta);
+  bool _unitPropagate(const Lit &lit);
   
-  // assigns pure and does the propagation, updates delta
-  void _pureAssign(const Lit &pure, _SolverDelta *delta);
+  // assigns pure and does the propagation, updates the top delta
+  void _pureAssign(const Lit &pure);
 
   // finds a unit clause in the current solver state, i.e. an active clause with 1 non-null watched literal.
   // outputs a ptr to the literal in the clause through out and returns true, or returns false if none.
@@ -185,27 +383,61 @@ class DPLLSolver : public Solver {
   // nb: active != unsat
   bool _allInactive() const;
 
-  // the CNF SAT instance we are working on
+  // the CNF SAT instance we are working on, renumbered by _renumbering, and the bytes
+  // taken by its clauses
   CNF _instance;
+  size_t _instance_bytes;
+  Renumbering _renumbering;
 
-  // the current model
-  Model _model;
+  // var -> 1 (true), -1 (false) or 0 (unassigned), the assignment during search
+  std::vector<int8_t> _vals;
 
   // the variables in this instance
   std::vector<var_t> _vars;
 
-  // the states of all clauses in the current instance
-  // indexing of this mirrors _instance.clauses
-  std::vector<_ClauseState> _clause_states;
-
-  std::stack<_SolverDelta> _deltas;
-  std::stack<Lit> _assn_stack;
-  std::deque<Lit> _unit_stack;
-
-  // x -> [i] s.t. x in C_i for each i in [i] (i indexes _instance.clauses)
-  std::unordered_map<var_t, std::vector<size_t>> _pos_map;
-  // ... see above but with ~x in C_i
-  std::unordered_map<var_t, std::vector<size_t>> _neg_map;
+  // var -> value var had when it was last unassigned (phase saving), or 0
+  std::vector<int8_t> _phases;
+
+  // the states of all clauses in the current instance, split into one array (or bit
+  // vector) per field so that scans over all clauses touch only what they need.
+  // indexing of these mirrors _instance.clauses.
+
+  // true if the clause is not sat under the current model, else false
+  BitVector _active;
+  // keeps track of whether or not the state has been modified
+  //  - false immediately after backtracking and before a decision
+  //  - true if this state was modified during a decision, false otherwise
+  BitVector _modified;
+  // the watched literals (null if none), and whether each is non-null
+  std::vector<Lit*> _watched_first;
+  std::vector<Lit*> _watched_second;
+  BitVector _has_first;
+  BitVector _has_second;
+  // index in the clause where the last watch replacement search stopped, the next
+  // search resumes there. restored along with the rest of the state on backtrack.
+  std::vector<size_t> _search_pos;
+
+  // the search stacks are flat vectors, which keep their memory when popped, so the
+  // search allocates nothing once they have grown to the depth of the search
+  std::vector<_SolverDelta> _deltas;
+  std::vector<Lit> _forced;
+  std::vector<std::pair<size_t, _ClauseState>> _priors;
+  std::vector<Lit> _assn_stack;
+  std::vector<Lit> _unit_stack;
+
+  // search statistics, checked against the limits at every decision and while
+  // propagating it. the memory budget is checked every MEMORY_CHECK_INTERVAL decisions.
+  uint64_t _conflicts;
+  uint64_t _decisions;
+  uint64_t _propagations;
+
+  // lit -> [i] s.t. lit in C_i for each i in [i] (i indexes _instance.clauses), where
+  // lit is keyed by _occKey
+  OccLists _occs;
+
+  inline static size_t _occKey(var_t var, bool sign) {
+    return 2 * static_cast<size_t>(var) + sign;
+  }
 };
 
 }
@@ -251,10 +483,31 @@ inline std::ostream &operator<<(std::ostream &os, const ccsat::Model &m) {
       });
 
   for (const auto &pair : sorted_pairs) {
-    std::cout << (pair.second ? "" : "-") << pair.first << " ";
+    os << (pair.second ? "" : "-") << pair.first << " ";
   }
 
   return os;
 }
 
+namespace ccsat {
+
+// writes m like operator<< does, with the variable numbers of the input of cnf
+inline std::ostream &writeModel(std::ostream &os, const Model &m, const CNF &cnf) {
+  std::vector<std::pair<uint64_t, bool>> sorted_pairs;
+  for (const auto &pair : m)
+    sorted_pairs.push_back(std::make_pair(cnf.name(pair.first), pair.second));
+
+  std::sort(sorted_pairs.begin(), sorted_pairs.end(),
+      [](const auto &a, const auto &b) {
+        return a.first < b.first;
+      });
+
+  for (const auto &pair : sorted_pairs)
+    os << (pair.second ? "" : "-") << pair.first << " ";
+
+  return os;
+}
+
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <utility>
+
+#include "Scheduler.h"
+
+namespace ccsat {
+
+const uint64_t Scheduler::FIRST_SLICE;
+const uint64_t Scheduler::MAX_SLICE;
+
+Scheduler::Scheduler(size_t num_threads, uint64_t first_slice) : _first_slice(first_slice) {
+  for (size_t i = 0; i < std::max<size_t>(num_threads, 1); ++i)
+    _workers.emplace_back([this]() { _work(); });
+}
+
+Scheduler::~Scheduler() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+
+  _queued.notify_all();
+  for (auto &worker : _workers)
+    worker.join();
+}
+
+void Scheduler::submit(Solver *solver, const CNF *cnf, Done done) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _push({solver, cnf, std::move(done), 0});
+    ++_pending;
+  }
+
+  _queued.notify_one();
+}
+
+void Scheduler::_push(_Job job) {
+  const uint64_t slice = job.slice;
+  _queue.emplace(std::make_pair(slice, _queued_count++), std::move(job));
+}
+
+bool Scheduler::waitFor(double seconds) {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  return _finished.wait_for(lock, std::chrono::duration<double>(seconds),
+      [this]() { return _pending == 0; });
+}
+
+void Scheduler::wait() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _finished.wait(lock, [this]() { return _pending == 0; });
+}
+
+void Scheduler::_work() {
+  while (true) {
+    _Job job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _queued.wait(lock, [this]() { return _stop || !_queue.empty(); });
+
+      if (_stop)
+        return;
+
+      job = std::move(_queue.begin()->second);
+      _queue.erase(_queue.begin());
+    }
+
+    if (!_run(job)) {
+      job.slice = std::min(2 * job.slice, MAX_SLICE);
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _push(std::move(job));
+      }
+      _queued.notify_one();
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --_pending;
+    }
+    _finished.notify_all();
+  }
+}
+
+bool Scheduler::_run(_Job &job) {
+  Result result;
+  try {
+    if (job.slice == 0) {
+      job.solver->begin(*job.cnf);
+      job.slice = _first_slice;
+    }
+
+    result = job.solver->resume(job.slice);
+  } catch (const std::exception &error) {
+    // the solve is abandoned, the other solves are not affected
+    if (job.done)
+      job.done(UNKNOWN, error.what());
+    return true;
+  }
+
+  if (!job.solver->finished())
+    return false;
+
+  if (job.done)
+    job.done(result, std::string());
+  return true;
+}
+
+}
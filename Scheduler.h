@@ -0,0 +1,92 @@
+#ifndef CCSAT_SCHEDULER_H
+#define CCSAT_SCHEDULER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "SAT.h"
+
+namespace ccsat {
+
+// runs many resumable solves (see Solver::begin) on a pool of worker threads, as a
+// multilevel feedback queue: every solve is resumed for a slice of propagation ticks
+// that doubles every time the solve uses it up, up to MAX_SLICE, and the workers always
+// resume the solve with the smallest slice next (round-robin among equal slices). a
+// newly submitted solve thus runs its first slice as soon as a worker is free, so easy
+// instances finish quickly wherever they are in the queue, while hard ones share the
+// workers in longer and longer slices.
+class Scheduler {
+ public:
+  // called from a worker with the result of a finished solve, and an error message
+  // that is empty unless the solve threw (e.g. std::bad_alloc), in which case the
+  // result is UNKNOWN
+  typedef std::function<void(Result, const std::string &)> Done;
+
+  explicit Scheduler(size_t num_threads, uint64_t first_slice = FIRST_SLICE);
+
+  // abandons the unfinished solves and stops the workers
+  ~Scheduler();
+
+  // queues a solve of cnf with solver, done (unless empty) is called when it finishes
+  // nb: solver and cnf must outlive the solve, and solver must not be used otherwise
+  //     until it finishes
+  void submit(Solver *solver, const CNF *cnf, Done done = Done());
+
+  // waits up to seconds for every submitted solve to finish, returns true if they did
+  bool waitFor(double seconds);
+
+  // waits for every submitted solve to finish
+  void wait();
+
+  // ticks of the first slice of a solve by default, and the largest slice
+  static const uint64_t FIRST_SLICE = 10000;
+  static const uint64_t MAX_SLICE = 10000000;
+
+ private:
+  struct _Job {
+    Solver *solver;
+    const CNF *cnf;
+    Done done;
+    // ticks of the next slice, 0 until the solve has begun
+    uint64_t slice;
+  };
+
+  // queues job behind the others with the same slice
+  // nb: _mutex must be held
+  void _push(_Job job);
+
+  // runs the solves of the queue until the scheduler stops
+  void _work();
+
+  // begins job if it has not begun yet and resumes it for its slice, returns true if
+  // the solve is finished (or failed, which is reported through done)
+  bool _run(_Job &job);
+
+  const uint64_t _first_slice;
+
+  std::mutex _mutex;
+  // signalled when a solve is queued or the workers must stop, and when a solve
+  // finishes
+  std::condition_variable _queued;
+  std::condition_variable _finished;
+  // the solves waiting for a worker by (slice, order of queueing): new solves first,
+  // then by increasing slice, round-robin among equal slices
+  std::map<std::pair<uint64_t, uint64_t>, _Job> _queue;
+  uint64_t _queued_count = 0;
+  // solves submitted and not finished yet
+  size_t _pending = 0;
+  bool _stop = false;
+
+  std::vector<std::thread> _workers;
+};
+
+}
+
+#endif
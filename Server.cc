@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Server.h"
+
+namespace ccsat {
+
+const size_t Server::MAX_REQUEST;
+
+// milliseconds between two checks of the stop flag while waiting for connections or
+// requests
+static const int POLL_MS = 100;
+
+// bytes read from a connection at once
+static const size_t READ_SIZE = 1 << 16;
+
+// a header line is short, anything longer is garbage
+static const size_t MAX_LINE = 256;
+
+// parses a request header "<format> <bytes> [<seconds> [<megabytes>]]" into its fields,
+// seconds and megabytes are 0 if absent. returns false unless the header has exactly
+// these fields, with a known format and a size that format allows.
+static bool parseHeader(const std::string &header, std::string *format, size_t *size,
+    double *seconds, size_t *megabytes) {
+  std::istringstream fields(header);
+  std::string size_field, seconds_field, megabytes_field, extra;
+  if (!(fields >> *format >> size_field)
+      || (fields >> seconds_field && fields >> megabytes_field && fields >> extra))
+    return false;
+
+  if (*format != "dimacs" && *format != "binary")
+    return false;
+
+  // all digits, at most MAX_REQUEST
+  if (size_field.size() > 10
+      || size_field.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  *size = std::stoull(size_field);
+  if (*size > Server::MAX_REQUEST || (*format == "binary" && *size % sizeof(int64_t) != 0))
+    return false;
+
+  *seconds = 0;
+  if (!seconds_field.empty()) {
+    char *end = nullptr;
+    *seconds = std::strtod(seconds_field.c_str(), &end);
+    if (*end != '\0' || !(*seconds >= 0))
+      return false;
+  }
+
+  // all digits, at most a petabyte
+  *megabytes = 0;
+  if (!megabytes_field.empty()) {
+    if (megabytes_field.size() > 10
+        || megabytes_field.find_first_not_of("0123456789") != std::string::npos)
+      return false;
+    *megabytes = std::stoull(megabytes_field);
+  }
+
+  return true;
+}
+
+// returns limits with its memory budget split evenly between num_workers solvers
+static Limits shareMemory(Limits limits, size_t num_workers) {
+  if (limits.memory > 0)
+    limits.memory = std::max<size_t>(limits.memory / std::max<size_t>(num_workers, 1), 1);
+
+  return limits;
+}
+
+// writes all of data to the socket fd, returns false if the peer is gone
+static bool writeAll(int fd, const std::string &data) {
+  size_t done = 0;
+  while (done < data.size()) {
+    ssize_t n = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+
+    done += n;
+  }
+
+  return true;
+}
+
+Server::Server(const std::string &path, Factory factory, size_t num_workers,
+    const Limits &limits) : _path(path), _factory(std::move(factory)),
+      _limits(shareMemory(limits, num_workers)) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path))
+    throw std::runtime_error("socket path too long: " + path);
+  std::strcpy(addr.sun_path, path.c_str());
+
+  // only a socket left behind by an earlier server is replaced
+  struct stat status;
+  if (::lstat(path.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode))
+      throw std::runtime_error("not a socket, refusing to replace it: " + path);
+    ::unlink(path.c_str());
+  } else if (errno != ENOENT) {
+    throw std::runtime_error("failed to stat " + path + ": " + std::strerror(errno));
+  }
+
+  _listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (_listener < 0)
+    throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+
+  if (::bind(_listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0
+      || ::listen(_listener, SOMAXCONN) < 0) {
+    std::string error = std::strerror(errno);
+    ::close(_listener);
+    throw std::runtime_error("failed to listen on " + path + ": " + error);
+  }
+
+  // nb: a full pipe is as good as any to wake the accepting thread, so writes never block
+  if (::pipe(_wake) < 0) {
+    std::string error = std::strerror(errno);
+    ::close(_listener);
+    ::unlink(path.c_str());
+    throw std::runtime_error(std::string("pipe: ") + error);
+  }
+  ::fcntl(_wake[0], F_SETFL, O_NONBLOCK);
+  ::fcntl(_wake[1], F_SETFL, O_NONBLOCK);
+
+  for (size_t i = 0; i < std::max<size_t>(num_workers, 1); ++i)
+    _solvers.emplace_back(_factory());
+
+  for (auto &solver : _solvers)
+    _workers.emplace_back([this, &solver]() { _work(solver.get()); });
+}
+
+Server::~Server() {
+  stop();
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+    _requests.clear();
+  }
+
+  _queued.notify_all();
+  for (auto &solver : _solvers)
+    solver->terminate();
+  for (auto &worker : _workers)
+    worker.join();
+
+  for (auto &connection : _connections)
+    ::close(connection.first);
+  _connections.clear();
+
+  ::close(_wake[0]);
+  ::close(_wake[1]);
+  ::close(_listener);
+  ::unlink(_path.c_str());
+}
+
+void Server::run() {
+  std::vector<pollfd> fds;
+
+  while (!_stop.load()) {
+    _reclaim();
+
+    // the listener, the wake pipe, and the connections waiting for a request
+    fds.clear();
+    fds.push_back({_listener, POLLIN, 0});
+    fds.push_back({_wake[0], POLLIN, 0});
+    for (const auto &connection : _connections)
+      if (!connection.second.busy)
+        fds.push_back({connection.first, POLLIN, 0});
+
+    if (::poll(fds.data(), fds.size(), POLL_MS) <= 0)
+      continue;
+
+    if (fds[1].revents != 0) {
+      char drain[64];
+      while (::read(_wake[0], drain, sizeof(drain)) > 0) {}
+    }
+
+    if (fds[0].revents & POLLIN) {
+      int fd = ::accept(_listener, nullptr, nullptr);
+      if (fd >= 0)
+        _connections[fd];
+    }
+
+    for (size_t i = 2; i < fds.size(); ++i)
+      if (fds[i].revents != 0)
+        _receive(fds[i].fd);
+  }
+
+  // the running solves answer unknown
+  for (auto &solver : _solvers)
+    solver->terminate();
+}
+
+void Server::_receive(int fd) {
+  _Connection &connection = _connections[fd];
+
+  char buffer[READ_SIZE];
+  ssize_t n;
+  do {
+    n = ::read(fd, buffer, sizeof(buffer));
+  } while (n < 0 && errno == EINTR);
+
+  // the client is gone, a request it left unfinished is dropped
+  if (n <= 0) {
+    _close(fd);
+    return;
+  }
+
+  connection.buffer.append(buffer, n);
+  _dispatch(fd);
+}
+
+void Server::_dispatch(int fd) {
+  _Connection &connection = _connections[fd];
+  std::string &buffer = connection.buffer;
+
+  const size_t end = buffer.find('\n');
+  if (end == std::string::npos) {
+    if (buffer.size() > MAX_LINE) {
+      writeAll(fd, "error bad request header\n");
+      _close(fd);
+    }
+    return;
+  }
+
+  const std::string header = buffer.substr(0, end);
+  _Request request;
+  size_t size = 0;
+  if (end > MAX_LINE
+      || !parseHeader(header, &request.format, &size, &request.seconds, &request.megabytes)) {
+    writeAll(fd, "error bad request header: " + header.substr(0, MAX_LINE) + "\n");
+    _close(fd);
+    return;
+  }
+
+  if (buffer.size() - end - 1 < size)
+    return;
+
+  request.fd = fd;
+  request.payload = buffer.substr(end + 1, size);
+  buffer.erase(0, end + 1 + size);
+  connection.busy = true;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _requests.push_back(std::move(request));
+  }
+  _queued.notify_one();
+}
+
+void Server::_close(int fd) {
+  ::close(fd);
+  _connections.erase(fd);
+}
+
+void Server::_reclaim() {
+  std::vector<std::pair<int, bool>> answered;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    answered.swap(_answered);
+  }
+
+  for (const auto &pair : answered) {
+    if (!pair.second) {
+      _close(pair.first);
+      continue;
+    }
+
+    // the client may have sent its next request already
+    _connections[pair.first].busy = false;
+    _dispatch(pair.first);
+  }
+}
+
+void Server::_work(Solver *solver) {
+  while (true) {
+    _Request request;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _queued.wait(lock, [this]() { return _stopping || !_requests.empty(); });
+
+      if (_stopping)
+        return;
+
+      request = std::move(_requests.front());
+      _requests.pop_front();
+    }
+
+    const bool keep = _serve(request, solver);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _answered.push_back({request.fd, keep});
+    }
+
+    const char wake = 0;
+    while (::write(_wake[1], &wake, 1) < 0 && errno == EINTR) {}
+  }
+}
+
+bool Server::_serve(const _Request &request, Solver *solver) {
+  // a request that fails (a parse error, or running out of memory) is answered with an
+  // error, the other connections are not affected
+  std::ostringstream answer;
+  try {
+    // nb: the binary format is read in host order, little-endian on the targets we run
+    CNF cnf;
+    if (request.format == "dimacs") {
+      std::istringstream text(request.payload);
+      cnf = CNF::fromDIMACS(text);
+    } else {
+      std::vector<int64_t> lits(request.payload.size() / sizeof(int64_t));
+      std::memcpy(lits.data(), request.payload.data(), request.payload.size());
+      cnf = CNF::fromBinary(lits.data(), lits.size());
+    }
+
+    // the request's limits may only tighten the server's
+    Limits limits = _limits;
+    if (request.seconds > 0 && (limits.time == 0 || request.seconds < limits.time))
+      limits.time = request.seconds;
+    const size_t memory = request.megabytes << 20;
+    if (memory > 0 && (limits.memory == 0 || memory < limits.memory))
+      limits.memory = memory;
+
+    // cleared before checking the stop flag, so a stop cannot be missed (run sets the
+    // flag first, and terminates the solvers after)
+    solver->clearTerminate();
+    if (_stop.load())
+      return false;
+
+    solver->setLimits(limits);
+    Result result = solver->solve(cnf);
+
+    answer << toString(result) << "\n";
+    if (result == SAT)
+      writeModel(answer, solver->getModel(), cnf) << "\n";
+  } catch (const std::exception &error) {
+    writeAll(request.fd, std::string("error ") + error.what() + "\n");
+    return false;
+  }
+
+  return writeAll(request.fd, answer.str());
+}
+
+}
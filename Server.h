@@ -0,0 +1,134 @@
+#ifndef CCSAT_SERVER_H
+#define CCSAT_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SAT.h"
+
+namespace ccsat {
+
+// solver daemon listening on a unix domain socket. the accepting thread polls every open
+// connection and reads whole requests, which are queued and served by a pool of warm
+// worker threads that each keep one solver for all the requests they serve, so that
+// per-instance costs (process startup, allocator warm-up) are paid once. a worker only
+// holds a connection while it serves one of its requests, so idle clients cost no
+// worker.
+//
+// a connection carries any number of requests, answered in order: the next request of
+// a connection is dispatched once the previous one is answered. a request is a header
+// line followed by a payload of the given size in bytes:
+//
+//   dimacs <bytes> [<seconds> [<megabytes>]]   the payload is a DIMACS instance
+//   binary <bytes> [<seconds> [<megabytes>]]   the payload is an instance in the
+//                                              format of CNF::fromBinary, little-endian
+//
+// with an optional time limit in seconds (0 for the server's) and memory budget in
+// megabytes, capped by the server's own. the answer is one of the lines
+//
+//   sat                          followed by a line with the model, as ccsat prints it
+//   unsat
+//   unknown                      a limit of the request or the server was reached
+//   error <message>              the request was malformed or failed (e.g. out of
+//                                memory), the connection is closed
+class Server {
+ public:
+  // returns a new solver for a worker
+  typedef std::function<Solver *()> Factory;
+
+  // listens on the socket at path, replacing a stale socket file. limits apply to every
+  // request, except for the memory budget, which is split evenly between the workers.
+  // throws std::runtime_error if the socket cannot be set up, or path exists and is not
+  // a socket.
+  Server(const std::string &path, Factory factory, size_t num_workers, const Limits &limits);
+
+  // stops the workers, cancelling their solves, closes the connections and removes the
+  // socket file
+  // nb: run must have returned
+  ~Server();
+
+  // accepts connections and reads their requests until stop is called
+  void run();
+
+  // makes run return soon, cancelling the running solves. may be called from any thread
+  // and from signal handlers.
+  inline void stop() { _stop.store(true); }
+
+  // requests larger than this are refused
+  static const size_t MAX_REQUEST = size_t(1) << 30;
+
+ private:
+  // an open connection, owned by the accepting thread
+  struct _Connection {
+    // bytes read from the connection and not consumed by a request yet
+    std::string buffer;
+    // whether a request of the connection is queued or being served, the connection is
+    // not polled meanwhile
+    bool busy = false;
+  };
+
+  // a request read from the connection fd, see parseHeader
+  struct _Request {
+    int fd;
+    std::string format;
+    double seconds;
+    size_t megabytes;
+    std::string payload;
+  };
+
+  // reads what the connection fd has to offer, and dispatches its next request
+  void _receive(int fd);
+
+  // queues the next request buffered for the connection fd if it is complete, answers
+  // an error and closes the connection if its header is malformed
+  void _dispatch(int fd);
+
+  // closes the connection fd
+  void _close(int fd);
+
+  // takes back the connections whose requests the workers answered
+  void _reclaim();
+
+  // serves queued requests with solver until the server stops
+  void _work(Solver *solver);
+
+  // answers request with solver, returns false if the connection must be closed
+  bool _serve(const _Request &request, Solver *solver);
+
+  const std::string _path;
+  const Factory _factory;
+  const Limits _limits;
+  int _listener;
+  // a pipe the workers write to, to wake the accepting thread when they answered
+  int _wake[2];
+
+  std::atomic<bool> _stop{false};
+
+  // open connections by fd
+  std::unordered_map<int, _Connection> _connections;
+
+  std::mutex _mutex;
+  // signalled when a request is queued or the workers must stop
+  std::condition_variable _queued;
+  std::deque<_Request> _requests;
+  // connections whose request was answered, and whether to keep them open
+  std::vector<std::pair<int, bool>> _answered;
+  bool _stopping = false;
+
+  // the solver of every worker, for cancelling their solves on stop
+  std::vector<std::unique_ptr<Solver>> _solvers;
+  std::vector<std::thread> _workers;
+};
+
+}
+
+#endif
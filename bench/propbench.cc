@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../SAT.h"
+#include "../CDCL.h"
+#include "../HugePages.h"
+
+// times the search of the clause-learning engine on the given instances, up to a budget
+// of propagations, excluding parsing and loading (begin). built with and without
+// -DCCSAT_NO_PREFETCH by `make bench` to measure the effect of prefetching in
+// propagation.
+
+// returns a random instance with clauses of width 3 (50%), 4 (30%) and 5 (20%), the
+// mix keeps the engine on its general watch lists rather than a fixed-width kernel
+static ccsat::CNF randomCNF(uint32_t vars, uint32_t clauses, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> coin(0, 1);
+
+  ccsat::CNF cnf;
+  for (uint32_t c = 0; c < clauses; ++c) {
+    double r = coin(rng);
+    size_t width = (r < 0.5) ? 3 : (r < 0.8) ? 4 : 5;
+
+    ccsat::Clause clause;
+    for (size_t i = 0; i < width; ++i)
+      clause.lits.push_back({static_cast<ccsat::var_t>(rng() % vars + 1), coin(rng) < 0.5});
+
+    cnf.clauses.push_back(clause);
+  }
+
+  return cnf;
+}
+
+int main(int argc, char **argv) {
+  int repeat = 3;
+  ccsat::Limits limits;
+  limits.propagations = 20000000;
+  std::vector<std::pair<std::string, ccsat::CNF>> instances;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+
+    if (arg.compare(0, 9, "--repeat=") == 0) {
+      repeat = std::atoi(arg.c_str() + 9);
+    } else if (arg.compare(0, 15, "--propagations=") == 0) {
+      limits.propagations = std::strtoull(arg.c_str() + 15, nullptr, 10);
+    } else if (arg == "--huge-pages=on" || arg == "--huge-pages=off") {
+      ccsat::setHugePages(arg == "--huge-pages=on");
+    } else if (arg.compare(0, 9, "--random=") == 0) {
+      // --random=VARS:CLAUSES:SEED
+      uint32_t vars = 0, clauses = 0, seed = 0;
+      if (std::sscanf(arg.c_str() + 9, "%u:%u:%u", &vars, &clauses, &seed) != 3 || vars == 0) {
+        std::cerr << "bad " << arg << std::endl;
+        return 1;
+      }
+
+      instances.emplace_back(arg.substr(9), randomCNF(vars, clauses, seed));
+    } else {
+      std::ifstream bench(arg);
+      if (!bench.is_open()) {
+        std::cerr << "failed to open " << arg << std::endl;
+        return 1;
+      }
+
+      try {
+        instances.emplace_back(arg, ccsat::CNF::fromDIMACS(bench));
+      } catch (const std::runtime_error &error) {
+        std::cerr << arg << ": parse error, " << error.what() << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  if (instances.empty()) {
+    std::cerr << "usage: " << argv[0] << " [--repeat=N] [--propagations=N]"
+              << " [--random=VARS:CLAUSES:SEED]"
+              << " [--huge-pages=on|off]"
+              << " [bench.cnf ...]" << std::endl;
+    return 1;
+  }
+
+  double total = 0;
+  for (const auto &instance : instances) {
+    // the best of repeat runs, the engine is deterministic
+    double best = 0;
+    ccsat::Result result = ccsat::UNKNOWN;
+    for (int r = 0; r < repeat; ++r) {
+      ccsat::CDCLSolver solver;
+      solver.setLimits(limits);
+      solver.begin(instance.second);
+
+      auto start = std::chrono::steady_clock::now();
+      result = solver.resume(0);
+      std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+
+      if (r == 0 || ms.count() < best)
+        best = ms.count();
+    }
+
+    total += best;
+    std::cout << instance.first << " " << ccsat::toString(result) << " " << best << " ms"
+              << std::endl;
+  }
+
+  std::cout << "total " << total << " ms" << std::endl;
+
+  return 0;
+}
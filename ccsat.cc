@@ -1,45 +1,278 @@
 #include <iostream>
+#include <algorithm>
+#include <csignal>
 #include <cstdlib>
 #include <cstdint>
 #include <fstream>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "SAT.h"
+#include "Async.h"
+#include "Scheduler.h"
+#include "Server.h"
+#include "Lookahead.h"
+#include "CDCL.h"
+#include "HugePages.h"
 
-int main(int argc, char **argv) {
-  if (argc < 2) {
-    std::cerr << "usage: " << argv[0] << " bench.cnf [...]" << std::endl;
+// set by SIGINT (and SIGTERM in server mode), the running solve is cancelled and the
+// remaining benches skipped, or the server stopped
+static volatile std::sig_atomic_t interrupted = 0;
+static ccsat::Server *server = nullptr;
+
+static void onInterrupt(int) {
+  interrupted = 1;
+  if (server != nullptr)
+    server->stop();
+}
+
+// prints the result of a solve of cnf, and the model if it is sat
+static void printResult(ccsat::Result result, const ccsat::CNF &cnf,
+    const ccsat::Solver &solver) {
+  std::cout << ccsat::toString(result) << std::endl;
+  if (result != ccsat::SAT)
+    return;
+
+  if (cnf.eval(solver.getModel())) {
+    std::cout << "model validated" << std::endl;
+  } else {
+    std::cout << "invalid model" << std::endl;
+  }
+
+  ccsat::writeModel(std::cout, solver.getModel(), cnf) << std::endl;
+}
+
+// returns a new solver for the given engine name, or nullptr if unknown. the restart
+// and phase policies, and the proof output, only apply to the cdcl engine.
+static ccsat::Solver *makeSolver(const std::string &name, const std::string &restart,
+    const std::string &phase, std::ostream *proof) {
+  if (name == "dpll")
+    return new ccsat::DPLLSolver();
+  if (name == "lookahead")
+    return new ccsat::LookaheadSolver();
+  if (name == "cdcl")
+    return ccsat::makeCDCLSolver(restart, phase, proof);
+
+  return nullptr;
+}
+
+// runs the solver daemon on the unix domain socket at path with workers threads (one
+// per core if 0), until interrupted
+static int serve(const std::string &path, const std::string &engine,
+    const std::string &restart, const std::string &phase, const ccsat::Limits &limits,
+    size_t workers) {
+  std::unique_ptr<ccsat::Solver> solver(makeSolver(engine, restart, phase, nullptr));
+  if (!solver) {
+    std::cerr << "unknown solver " << engine << " (restarts " << restart << ", phases "
+              << phase << ")" << std::endl;
+    return 1;
+  }
+
+  if (workers == 0)
+    workers = std::max(1u, std::thread::hardware_concurrency());
+
+  try {
+    ccsat::Server daemon(path, [&]() { return makeSolver(engine, restart, phase, nullptr); },
+        workers, limits);
+
+    server = &daemon;
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+
+    std::cerr << "listening on " << path << " with " << workers << " workers" << std::endl;
+    daemon.run();
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    server = nullptr;
+  } catch (const std::runtime_error &error) {
+    std::cerr << error.what() << std::endl;
     return 1;
   }
 
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  std::string engine = "dpll";
+  std::string restart = "stable";
+  std::string phase = "target";
+  std::string proof_path;
+  ccsat::Limits limits;
+  double progress = 0;
+  size_t jobs = 0;
+  std::string server_path;
+  std::vector<std::string> benches;
+
   for (int i = 1; i < argc; ++i) {
-    std::ifstream bench(argv[i]);
+    std::string arg(argv[i]);
+
+    if (arg.compare(0, 9, "--solver=") == 0) {
+      engine = arg.substr(9);
+    } else if (arg.compare(0, 10, "--restart=") == 0) {
+      restart = arg.substr(10);
+    } else if (arg.compare(0, 8, "--phase=") == 0) {
+      phase = arg.substr(8);
+    } else if (arg.compare(0, 8, "--proof=") == 0) {
+      proof_path = arg.substr(8);
+    } else if (arg == "--huge-pages=on" || arg == "--huge-pages=off") {
+      ccsat::setHugePages(arg == "--huge-pages=on");
+    } else if (arg.compare(0, 13, "--lean-above=") == 0) {
+      limits.lean = std::strtoull(arg.c_str() + 13, nullptr, 10) << 20;
+    } else if (arg.compare(0, 10, "--max-mem=") == 0) {
+      limits.memory = std::strtoull(arg.c_str() + 10, nullptr, 10) << 20;
+    } else if (arg.compare(0, 7, "--time=") == 0) {
+      limits.time = std::strtod(arg.c_str() + 7, nullptr);
+    } else if (arg.compare(0, 12, "--conflicts=") == 0) {
+      limits.conflicts = std::strtoull(arg.c_str() + 12, nullptr, 10);
+    } else if (arg.compare(0, 12, "--decisions=") == 0) {
+      limits.decisions = std::strtoull(arg.c_str() + 12, nullptr, 10);
+    } else if (arg.compare(0, 15, "--propagations=") == 0) {
+      limits.propagations = std::strtoull(arg.c_str() + 15, nullptr, 10);
+    } else if (arg.compare(0, 11, "--progress=") == 0) {
+      progress = std::strtod(arg.c_str() + 11, nullptr);
+    } else if (arg.compare(0, 9, "--server=") == 0) {
+      server_path = arg.substr(9);
+    } else if (arg.compare(0, 7, "--jobs=") == 0) {
+      jobs = std::strtoull(arg.c_str() + 7, nullptr, 10);
+    } else {
+      benches.push_back(arg);
+    }
+  }
+
+  if (!server_path.empty())
+    return serve(server_path, engine, restart, phase, limits, jobs);
+
+  if (benches.empty()) {
+    std::cerr << "usage: " << argv[0] << " [--solver=dpll|lookahead|cdcl]"
+              << " [--restart=luby|glucose|stable] [--phase=target|saved] [--proof=FILE]"
+              << " [--huge-pages=on|off] [--lean-above=MB] [--max-mem=MB]"
+              << " [--time=SEC] [--conflicts=N] [--decisions=N] [--propagations=N]"
+              << " [--progress=SEC] [--jobs=N]"
+              << " bench.cnf [...]" << std::endl;
+    std::cerr << "       " << argv[0] << " --server=SOCKET [--jobs=N] [solver and limit options]"
+              << std::endl;
+    return 1;
+  }
+
+  if (jobs > 0 && !proof_path.empty()) {
+    std::cerr << "--proof cannot be combined with --jobs" << std::endl;
+    return 1;
+  }
+
+  // the proof of every bench is appended to the same file
+  std::ofstream proof;
+  if (!proof_path.empty()) {
+    proof.open(proof_path);
+    if (!proof.is_open()) {
+      std::cerr << "failed to open " << proof_path << std::endl;
+      return 1;
+    }
+  }
+
+  std::signal(SIGINT, onInterrupt);
+
+  // with --jobs every bench is loaded first, and the solves are interleaved by a
+  // scheduler. otherwise the benches are loaded and solved one at a time.
+  std::vector<ccsat::CNF> cnfs(jobs > 0 ? benches.size() : 1);
+  std::vector<std::unique_ptr<ccsat::Solver>> solvers(cnfs.size());
+  std::vector<ccsat::Result> results(cnfs.size(), ccsat::UNKNOWN);
+  // the error of every solve of the scheduler that failed, empty for the others
+  std::vector<std::string> errors(cnfs.size());
+  std::unique_ptr<ccsat::Scheduler> scheduler;
+  if (jobs > 0)
+    scheduler.reset(new ccsat::Scheduler(jobs));
+
+  // with --jobs every instance stays loaded until the end, so the memory budget is
+  // split evenly between them
+  if (jobs > 0 && limits.memory > 0)
+    limits.memory = std::max<size_t>(limits.memory / benches.size(), 1);
+
+  for (size_t i = 0; i < benches.size(); ++i) {
+    if (interrupted)
+      break;
+
+    const size_t k = (jobs > 0) ? i : 0;
+
+    std::ifstream bench(benches[i]);
     if (!bench.is_open()) {
-      std::cerr << "failed to open " << argv[i] << std::endl;
+      std::cerr << "failed to open " << benches[i] << std::endl;
       return 1;
     }
 
-    ccsat::CNF cnf = ccsat::CNF::fromDIMACS(bench);
+    try {
+      cnfs[k] = ccsat::CNF::fromDIMACS(bench);
+    } catch (const std::runtime_error &error) {
+      std::cerr << benches[i] << ": parse error, " << error.what() << std::endl;
+      return 1;
+    }
 
     bench.close();
 
-    ccsat::Solver *solver = new ccsat::DPLLSolver();
-    bool sat = solver->solve(cnf);
+    solvers[k].reset(makeSolver(engine, restart, phase, proof.is_open() ? &proof : nullptr));
+    if (!solvers[k]) {
+      std::cerr << "unknown solver " << engine << " (restarts " << restart << ", phases "
+                << phase << ")" << std::endl;
+      return 1;
+    }
 
-    std::cout << (sat ? "sat" : "unsat") << std::endl;
-    if (sat) {
-      if (cnf.eval(solver->getModel())) {
-        std::cout << "model validated" << std::endl;
-      } else {
-        std::cout << "invalid model" << std::endl;
-      }
+    ccsat::Solver *solver = solvers[k].get();
+    solver->setLimits(limits);
+    if (progress > 0) {
+      const std::string path = benches[i];
+      solver->setProgress([path](const ccsat::Stats &stats) {
+        std::ostringstream line;
+        line << "c " << path << " " << stats.seconds << "s: " << stats.conflicts
+             << " conflicts, " << stats.decisions << " decisions, " << stats.propagations
+             << " propagations\n";
+        std::cerr << line.str();
+      }, progress);
+    }
 
-      std::cout << solver->getModel() << std::endl;
+    if (jobs > 0) {
+      scheduler->submit(solver, &cnfs[k],
+          [&results, &errors, k](ccsat::Result result, const std::string &error) {
+        results[k] = result;
+        errors[k] = error;
+      });
+      continue;
     }
 
-    delete solver;
+    // solve on another thread, so that an interrupt can cancel the solve
+    ccsat::SolveHandle handle = ccsat::solveAsync(solver, cnfs[k]);
+    while (!handle.waitFor(0.05)) {
+      if (interrupted)
+        handle.cancel();
+    }
+
+    printResult(handle.get(), cnfs[k], *solver);
+    solvers[k].reset();
+  }
+
+  if (jobs > 0) {
+    while (!scheduler->waitFor(0.05)) {
+      if (interrupted) {
+        for (auto &solver : solvers)
+          if (solver)
+            solver->terminate();
+      }
+    }
+
+    for (size_t i = 0; i < benches.size(); ++i) {
+      if (!solvers[i])
+        break;
+
+      std::cout << benches[i] << std::endl;
+      if (!errors[i].empty())
+        std::cout << "error " << errors[i] << std::endl;
+      else
+        printResult(results[i], cnfs[i], *solvers[i]);
+    }
   }
 
   return 0;
-}
\ No newline at end of file
+}
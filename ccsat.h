@@ -0,0 +1,89 @@
+#ifndef CCSAT_H
+#define CCSAT_H
+
+// C API of the ccsat library (libccsat.so and libccsat.a), for solving instances in
+// process. a solver is an opaque handle holding an instance, built clause by clause
+// with DIMACS literals, and the model of its last solve:
+//
+//   ccsat_solver *solver = ccsat_new("cdcl");
+//   ccsat_add(solver, 1); ccsat_add(solver, -2); ccsat_add(solver, 0);
+//   if (ccsat_solve(solver) == CCSAT_SAT)
+//     n = ccsat_model(solver, lits, size);
+//   ccsat_delete(solver);
+//
+// the functions never throw, and a handle may only be used by one thread at a time,
+// except for ccsat_terminate.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define CCSAT_API __attribute__((visibility("default")))
+#else
+#define CCSAT_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// results of ccsat_solve, the exit codes of SAT competition solvers
+#define CCSAT_UNKNOWN 0
+#define CCSAT_SAT 10
+#define CCSAT_UNSAT 20
+// the solve failed, e.g. out of memory, or an argument was invalid
+#define CCSAT_ERROR (-1)
+
+typedef struct ccsat_solver ccsat_solver;
+
+// returns a new solver with an empty instance, running the engine "dpll", "lookahead"
+// or "cdcl" (as with ccsat --solver, "dpll" if null). returns null if the engine is
+// unknown.
+CCSAT_API ccsat_solver *ccsat_new(const char *engine);
+
+// frees the solver, which must not be solving
+CCSAT_API void ccsat_delete(ccsat_solver *solver);
+
+// adds the DIMACS literal lit to the clause being built, or ends it if lit is 0.
+// variable numbers may be sparse and up to 63 bits. returns CCSAT_ERROR (and adds
+// nothing) if lit is INT64_MIN, otherwise 0.
+CCSAT_API int ccsat_add(ccsat_solver *solver, int64_t lit);
+
+// adds the clause of the count DIMACS literals lits, without terminator, after ending
+// the clause being built if any. returns CCSAT_ERROR (and adds nothing) if any literal
+// is INT64_MIN, otherwise 0.
+CCSAT_API int ccsat_add_clause(ccsat_solver *solver, const int64_t *lits, size_t count);
+
+// removes every clause, and the model
+CCSAT_API void ccsat_clear(ccsat_solver *solver);
+
+// sets the limits of the next solves, 0 for none: wall time in seconds, conflicts,
+// decisions, propagations (literals assigned) and the memory budget of the solver in
+// bytes. a solve reaching one answers CCSAT_UNKNOWN.
+CCSAT_API void ccsat_set_limits(ccsat_solver *solver, double seconds, uint64_t conflicts,
+    uint64_t decisions, uint64_t propagations, size_t memory);
+
+// solves the instance from scratch, ending a clause left without terminator (later
+// literals start a new clause). returns CCSAT_SAT, CCSAT_UNSAT, CCSAT_UNKNOWN (on a limit or ccsat_terminate)
+// or CCSAT_ERROR. the instance is kept, so clauses can be added and solved again.
+CCSAT_API int ccsat_solve(ccsat_solver *solver);
+
+// makes the running solve, or the next one if none is running, answer CCSAT_UNKNOWN
+// soon. may be called from any thread.
+CCSAT_API void ccsat_terminate(ccsat_solver *solver);
+
+// writes up to size literals of the model of the last solve into lits, one per
+// variable of the instance by increasing variable: var if it is true, -var if false.
+// returns the number of variables, which may exceed size, or 0 if the last solve did
+// not answer CCSAT_SAT.
+CCSAT_API size_t ccsat_model(const ccsat_solver *solver, int64_t *lits, size_t size);
+
+// returns var or -var, the literal of var true in the model of the last solve, or 0
+// if var is not in the instance or the last solve did not answer CCSAT_SAT
+CCSAT_API int64_t ccsat_value(const ccsat_solver *solver, int64_t var);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif